@@ -1,97 +1,190 @@
 #include "MPU6050.hpp"
+#include "mpuCalibrator.hpp"
+#include <stdlib.h>
+
+const byte MPU6050::FIFO_TEMP;
+const byte MPU6050::FIFO_GYRO;
+const byte MPU6050::FIFO_ACCEL;
+const byte MPU6050::INT_DATA_READY;
+const byte MPU6050::INT_FIFO_OVERFLOW;
+const byte MPU6050::INT_MOTION;
 
 int MPU6050::whoAmI(){
-	byte data[] = {MPU6050_WHO_AM_I};
-	i2c_bus.write(deviceAddress, data, 1);
-	i2c_bus.read(deviceAddress, data, 1);
-	int whoHeIs = data[0];
+	int whoHeIs = read8bit(MPU6050_WHO_AM_I);
 	return whoHeIs;
 }
 
 void MPU6050::wakeUp(){
-	byte data[] = {MPU6050_PWR_MGMT_1, 0};
+	byte data[] = {MPU6050_PWR_MGMT_1, byte(config.clock)};
 	i2c_bus.write(deviceAddress, data, 2);
 }
 
 byte MPU6050::read8bit(const byte & address){
-	byte data[] = {address};
-	i2c_bus.write(deviceAddress, data, 1);
-	i2c_bus.read(deviceAddress, data, 1);
+	byte data[1];
+	readRegisters(address, data, 1);
 	return *data;
 }
 
-int16_t MPU6050::read16bit(const byte & addressHigh, const byte & addressLow){
-	byte dataHigh = read8bit(addressHigh);
-	byte dataLow = read8bit(addressLow);
-	int16_t conversion = (dataHigh << 8) + dataLow;
+// The high and low register are read in one transaction, so they belong to
+// the same sample. The low register is always addressHigh + 1.
+int16_t MPU6050::read16bit(const byte & addressHigh){
+	byte data[2];
+	readRegisters(addressHigh, data, 2);
+	int16_t conversion = (data[0] << 8) | data[1];
 	return conversion;
 }
 
+// Sends the start register once and reads count bytes, the MPU6050
+// increments the register address after every byte.
+void MPU6050::readRegisters(const byte & startAddress, byte data[], const size_t & count){
+	i2c_bus.readRegisters(deviceAddress, startAddress, data, count);
+}
+
+void MPU6050::decodeAccel(const byte data[]){
+	accelX = (data[0] << 8) | data[1];
+	accelY = (data[2] << 8) | data[3];
+	accelZ = (data[4] << 8) | data[5];
+}
+
+void MPU6050::decodeTemp(const byte data[]){
+	temperature = (data[0] << 8) | data[1];
+	temperatureInCelcius = temperature/340 + 36;
+}
+
+void MPU6050::decodeGyro(const byte data[]){
+	gyroX = (data[0] << 8) | data[1];
+	gyroY = (data[2] << 8) | data[3];
+	gyroZ = (data[4] << 8) | data[5];
+}
+
+// Q16 scale per range, 1000 * 65536 / (LSB per g or per degree/s)
+static const int32_t ACCEL_SCALE_Q16[] = {4000, 8000, 16000, 32000};
+static const int32_t GYRO_SCALE_Q16[] = {500275, 1000550, 1998049, 3996098};
+
+void MPU6050::setScale(){
+	accelScaleQ16 = ACCEL_SCALE_Q16[fullScaleAccelRange & 0x03];
+	gyroScaleQ16 = GYRO_SCALE_Q16[fullScaleGyroRange & 0x03];
+}
+
 void MPU6050::setFullScaleGyroRange(byte gyroFullScaleSelect){
-	gyroFullScaleSelect = gyroFullScaleSelect << 3;
-	byte data[] = {MPU6050_GYRO_CONFIG, gyroFullScaleSelect};
-	i2c_bus.write(deviceAddress, data, 2);
+	config.gyroRange = mpuGyroRange(gyroFullScaleSelect & 0x03);
+	fullScaleGyroRange = byte(config.gyroRange);
+	setScale();
+	writeRegister(MPU6050_GYRO_CONFIG, fullScaleGyroRange << 3);
 }
-double MPU6050::getFullScaleGyroRange(){
-	byte data[] = {MPU6050_GYRO_CONFIG};
-	i2c_bus.write(deviceAddress, data, 1);
-	i2c_bus.read(deviceAddress, data, 1);
-	fullScaleGyroRange = (data[0] >> 3) & 0x03;
-	if (fullScaleGyroRange == 0) {
-		gyroSensitivity = 131.0;
-	} else if (fullScaleGyroRange == 1) {
-		gyroSensitivity =  65.5;
-	} else if (fullScaleGyroRange == 2) {
-		gyroSensitivity =  32.8;
-	} else if (fullScaleGyroRange == 3) {
-		gyroSensitivity =  16.4;
-	} else {
-		gyroSensitivity = 131.0;
-	}
-	return gyroSensitivity;
+byte MPU6050::getFullScaleGyroRange(){
+	return fullScaleGyroRange;
 }
 
 void MPU6050::setFullScaleAccelRange(byte accelFullScaleSelect){
-	accelFullScaleSelect = accelFullScaleSelect << 3;
-	byte data[] = {MPU6050_ACCEL_CONFIG, accelFullScaleSelect};
-	i2c_bus.write(deviceAddress, data, 2);
+	config.accelRange = mpuAccelRange(accelFullScaleSelect & 0x03);
+	fullScaleAccelRange = byte(config.accelRange);
+	setScale();
+	writeRegister(MPU6050_ACCEL_CONFIG, fullScaleAccelRange << 3);
 }
-double MPU6050::getFullScaleAccelRange(){
-	byte data[] = {MPU6050_ACCEL_CONFIG};
-	i2c_bus.write(deviceAddress, data, 1);
-	i2c_bus.read(deviceAddress, data, 1);
-	fullScaleAccelRange = (data[0] >> 3) & 0x03;
-	if (fullScaleAccelRange == 0) {
-		accelSensitivity = 16384.0;
-	} else if (fullScaleAccelRange == 1) {
-		accelSensitivity =  8192.0;
-	} else if (fullScaleAccelRange == 2) {
-		accelSensitivity =  4096.0;
-	} else if (fullScaleAccelRange == 3) {
-		accelSensitivity =  2048.0;
-	} else {
-		accelSensitivity = 16384.0;
-	}
-	return accelSensitivity;
+byte MPU6050::getFullScaleAccelRange(){
+	return fullScaleAccelRange;
+}
+
+// SMPLRT_DIV, CONFIG, GYRO_CONFIG and ACCEL_CONFIG are consecutive registers
+// and written in one burst, the clock source is in PWR_MGMT_1.
+void MPU6050::configure(const mpuConfig & newConfig){
+	config = newConfig;
+	fullScaleGyroRange = byte(config.gyroRange) & 0x03;
+	fullScaleAccelRange = byte(config.accelRange) & 0x03;
+	setScale();
+	byte data[] = {
+		MPU6050_SMPLRT_DIV,
+		config.sampleRateDivider,
+		byte(byte(config.dlpf) & 0x07),
+		byte(fullScaleGyroRange << 3),
+		byte(fullScaleAccelRange << 3)
+	};
+	i2c_bus.write(deviceAddress, data, 5);
+	writeRegister(MPU6050_PWR_MGMT_1, byte(config.clock) & 0x07);
 }
 
+mpuConfig MPU6050::getConfig(){
+	return config;
+}
+
+void MPU6050::setDlpf(const mpuDlpf & dlpf){
+	config.dlpf = dlpf;
+	writeRegister(MPU6050_CONFIG, byte(dlpf) & 0x07);
+}
+
+mpuDlpf MPU6050::getDlpf(){
+	return config.dlpf;
+}
+
+void MPU6050::setSampleRateDivider(const byte & divider){
+	config.sampleRateDivider = divider;
+	writeRegister(MPU6050_SMPLRT_DIV, divider);
+}
+
+byte MPU6050::getSampleRateDivider(){
+	return config.sampleRateDivider;
+}
+
+void MPU6050::setClockSource(const mpuClock & clock){
+	config.clock = clock;
+	writeRegister(MPU6050_PWR_MGMT_1, byte(clock) & 0x07);
+}
+
+mpuClock MPU6050::getClockSource(){
+	return config.clock;
+}
+
+uint32_t MPU6050::getGyroRateHz(){
+	return config.dlpf == mpuDlpf::BW_260HZ ? 8000 : 1000;
+}
+
+uint32_t MPU6050::getSampleRateHz(){
+	return getGyroRateHz() / (1 + config.sampleRateDivider);
+}
+
+// Offsets and scale in one integer pass. The 32x32 bit multiply into 64 bits
+// is a single instruction on the Cortex-M3, no floating point is used.
+void MPU6050::scale(const mpuSample & raw, mpuScaledSample & scaled){
+	scaled.timestamp = raw.timestamp;
+	scaled.accelX = (int64_t(int32_t(raw.accelX) - calibration.accelX) * accelScaleQ16) >> 16;
+	scaled.accelY = (int64_t(int32_t(raw.accelY) - calibration.accelY) * accelScaleQ16) >> 16;
+	scaled.accelZ = (int64_t(int32_t(raw.accelZ) - calibration.accelZ) * accelScaleQ16) >> 16;
+	scaled.gyroX = (int64_t(int32_t(raw.gyroX) - calibration.gyroX) * gyroScaleQ16) >> 16;
+	scaled.gyroY = (int64_t(int32_t(raw.gyroY) - calibration.gyroY) * gyroScaleQ16) >> 16;
+	scaled.gyroZ = (int64_t(int32_t(raw.gyroZ) - calibration.gyroZ) * gyroScaleQ16) >> 16;
+	scaled.temperature = (int32_t(raw.temperature) * 1000) / 340 + 36530;
+}
+
+void MPU6050::getScaledSample(mpuScaledSample & scaled){
+	mpuSample raw;
+	getSample(raw);
+	raw.timestamp = hwlib::now_us();
+	scale(raw, scaled);
+}
+
+// One burst over accel, temperature and gyro registers, so all values are
+// from the same sample.
 void MPU6050::setAccelGyro(){
-	setAccel();
-	setGyro();
+	byte data[BURST_SIZE];
+	readRegisters(MPU6050_ACCEL_XOUT_H, data, BURST_SIZE);
+	decodeAccel(data);
+	decodeTemp(data + 6);
+	decodeGyro(data + 8);
 }
 void MPU6050::setAccel(){
-	setAccelX();
-	setAccelY(); 
-	setAccelZ();
+	byte data[6];
+	readRegisters(MPU6050_ACCEL_XOUT_H, data, 6);
+	decodeAccel(data);
 }
 void MPU6050::setAccelX(){
-	accelX = read16bit(MPU6050_ACCEL_XOUT_H, MPU6050_ACCEL_XOUT_L);
+	accelX = read16bit(MPU6050_ACCEL_XOUT_H);
 }
 void MPU6050::setAccelY(){
-	accelY = read16bit(MPU6050_ACCEL_YOUT_H, MPU6050_ACCEL_YOUT_L);
+	accelY = read16bit(MPU6050_ACCEL_YOUT_H);
 }
 void MPU6050::setAccelZ(){
-	accelZ = read16bit(MPU6050_ACCEL_ZOUT_H, MPU6050_ACCEL_ZOUT_L);
+	accelZ = read16bit(MPU6050_ACCEL_ZOUT_H);
 }
 int16_t MPU6050::getAccelX(){
 	return accelX;
@@ -104,18 +197,18 @@ int16_t MPU6050::getAccelZ(){
 }
 
 void MPU6050::setGyro(){
-	setGyroX();
-	setGyroY();
-	setGyroZ();
+	byte data[6];
+	readRegisters(MPU6050_GYRO_XOUT_H, data, 6);
+	decodeGyro(data);
 }
 void MPU6050::setGyroX(){
-	gyroX = read16bit(MPU6050_GYRO_XOUT_H, MPU6050_GYRO_XOUT_L);
+	gyroX = read16bit(MPU6050_GYRO_XOUT_H);
 }
 void MPU6050::setGyroY(){
-	gyroY = read16bit(MPU6050_GYRO_YOUT_H, MPU6050_GYRO_YOUT_L);
+	gyroY = read16bit(MPU6050_GYRO_YOUT_H);
 }
 void MPU6050::setGyroZ(){
-	gyroZ = read16bit(MPU6050_GYRO_ZOUT_H, MPU6050_GYRO_ZOUT_L);
+	gyroZ = read16bit(MPU6050_GYRO_ZOUT_H);
 }
 int16_t MPU6050::getGyroX(){
 	return gyroX;
@@ -127,54 +220,54 @@ int16_t MPU6050::getGyroZ(){
 	return gyroZ;
 }
 
-void MPU6050::calibrate(){
-	hwlib::cout << "Calibration started, keep device still.\n";
-	hwlib::wait_ms(250);
-	uint32_t deltaAccelX = 0, deltaAccelY = 0, deltaAccelZ = 0;
-	uint32_t deltaGyroX = 0, deltaGyroY = 0, deltaGyroZ = 0;
-	for(unsigned int i = 0; i < 50; i++){
-		setAccelGyro();
-		deltaAccelX += getAccelX();
-		deltaAccelY += getAccelY();
-		deltaAccelZ += getAccelZ();
-		
-		deltaGyroX += getGyroX();
-		deltaGyroY += getGyroY();
-		deltaGyroZ += getGyroZ();
-		hwlib::wait_ms(50);
+// Blocking wrapper around mpuCalibrator, for when nothing else has to run.
+// A device that does not lie still never settles, so after timeoutMs it
+// gives up, keeps the old offsets and returns false.
+bool MPU6050::calibrate(const uint32_t & timeoutMs){
+	mpuCalibrator calibrator(*this);
+	calibrator.start();
+	uint_fast64_t start = hwlib::now_us();
+	while(!calibrator.step()){
+		if(hwlib::now_us() - start >= uint_fast64_t(timeoutMs) * 1000){
+			calibrator.stop();
+			return false;
+		}
 	}
-	offsetAccelX = deltaAccelX / 50;
-	offsetAccelY = deltaAccelY / 50; 
-	offsetAccelZ = deltaAccelZ / 50;
-	offsetGyroX = deltaGyroX / 50; 
-	offsetGyroY = deltaGyroY / 50; 
-	offsetGyroZ = deltaGyroZ / 50;
-	hwlib::cout << "Calibration complete.\n";
+	return true;
 }
 
-uint16_t MPU6050::getOffsetAccelX(){
-	return offsetAccelX;
+int16_t MPU6050::getOffsetAccelX(){
+	return calibration.accelX;
 }
-uint16_t MPU6050::getOffsetAccelY(){
-	return offsetAccelY;
+int16_t MPU6050::getOffsetAccelY(){
+	return calibration.accelY;
 }
-uint16_t MPU6050::getOffsetAccelZ(){
-	return offsetAccelZ;
+int16_t MPU6050::getOffsetAccelZ(){
+	return calibration.accelZ;
 }
 
-uint16_t MPU6050::getOffsetGyroX(){
-	return offsetGyroX;
+int16_t MPU6050::getOffsetGyroX(){
+	return calibration.gyroX;
 }
-uint16_t MPU6050::getOffsetGyroY(){
-	return offsetGyroY;
+int16_t MPU6050::getOffsetGyroY(){
+	return calibration.gyroY;
 }
-uint16_t MPU6050::getOffsetGyroZ(){
-	return offsetGyroZ;
+int16_t MPU6050::getOffsetGyroZ(){
+	return calibration.gyroZ;
+}
+
+mpuCalibration MPU6050::getCalibration(){
+	return calibration;
+}
+
+void MPU6050::setCalibration(const mpuCalibration & newCalibration){
+	calibration = newCalibration;
 }
 
 void MPU6050::setTemp() {
-	temperature = read16bit(MPU6050_TEMP_OUT_H, MPU6050_TEMP_OUT_L);
-	temperatureInCelcius = temperature/340 + 36.53;
+	byte data[2];
+	readRegisters(MPU6050_TEMP_OUT_H, data, 2);
+	decodeTemp(data);
 }
 
 int16_t MPU6050::getTempInCelcius() {
@@ -183,4 +276,191 @@ int16_t MPU6050::getTempInCelcius() {
 
 int16_t MPU6050::getTemp() {
 	return temperatureInCelcius;
+}
+
+void MPU6050::writeRegister(const byte & address, const byte & data){
+	byte buffer[] = {address, data};
+	i2c_bus.write(deviceAddress, buffer, 2);
+}
+
+// Selects the sensors written to the FIFO and the sample rate, which is the
+// gyro output rate (8 kHz without DLPF, 1 kHz with) / (1 + sampleRateDivider).
+void MPU6050::enableFifo(const byte & sensors, const byte & sampleRateDivider){
+	fifoSensors = sensors & (FIFO_TEMP | FIFO_GYRO | FIFO_ACCEL);
+	fifoSampleSize = 0;
+	if(fifoSensors & FIFO_ACCEL){
+		fifoSampleSize += 6;
+	}
+	if(fifoSensors & FIFO_TEMP){
+		fifoSampleSize += 2;
+	}
+	for(byte bit = 0x40; bit >= 0x10; bit >>= 1){
+		if(fifoSensors & bit){
+			fifoSampleSize += 2;
+		}
+	}
+	setSampleRateDivider(sampleRateDivider);
+	fifoSamplePeriodUs = (1000000 / getGyroRateHz()) * (1 + sampleRateDivider);
+	
+	writeRegister(MPU6050_FIFO_EN, fifoSensors);
+	resetFifo();
+}
+
+void MPU6050::disableFifo(){
+	writeRegister(MPU6050_FIFO_EN, 0);
+	writeRegister(MPU6050_USER_CTRL, 0);
+	fifoSensors = 0;
+	fifoSampleSize = 0;
+}
+
+void MPU6050::resetFifo(){
+	writeRegister(MPU6050_USER_CTRL, USER_CTRL_FIFO_RESET);
+	writeRegister(MPU6050_USER_CTRL, USER_CTRL_FIFO_EN);
+	read8bit(MPU6050_INT_STATUS);
+}
+
+uint16_t MPU6050::getFifoCount(){
+	return uint16_t(read16bit(MPU6050_FIFO_COUNT_H));
+}
+
+// The FIFO holds the enabled sensors in register order: accel, temp, gyro
+// x, y, z.
+void MPU6050::decodeFifoSample(const byte data[], mpuSample & sample){
+	sample = mpuSample{};
+	if(fifoSensors & FIFO_ACCEL){
+		sample.accelX = (data[0] << 8) | data[1];
+		sample.accelY = (data[2] << 8) | data[3];
+		sample.accelZ = (data[4] << 8) | data[5];
+		data += 6;
+	}
+	if(fifoSensors & FIFO_TEMP){
+		sample.temperature = (data[0] << 8) | data[1];
+		data += 2;
+	}
+	int16_t * gyro[] = {&sample.gyroX, &sample.gyroY, &sample.gyroZ};
+	for(byte i = 0; i < 3; i++){
+		if(fifoSensors & (0x40 >> i)){
+			*gyro[i] = (data[0] << 8) | data[1];
+			data += 2;
+		}
+	}
+}
+
+// Moves all complete samples from the FIFO into the ring buffer, at most
+// FIFO_BURST_SAMPLES per burst read. A full FIFO has lost samples and holds a
+// partial one, so it is reset instead. Returns the number of new samples.
+unsigned int MPU6050::drainFifo(){
+	if(fifoSampleSize == 0){
+		return 0;
+	}
+	return drainFifo(read8bit(MPU6050_INT_STATUS));
+}
+
+// Same, with INT_STATUS already read by the caller. Reading INT_STATUS
+// clears FIFO_OFLOW, so a caller that read it has to pass it on.
+unsigned int MPU6050::drainFifo(const byte & status){
+	if(fifoSampleSize == 0){
+		return 0;
+	}
+	uint16_t count = getFifoCount();
+	if((status & INT_STATUS_FIFO_OFLOW) || count >= FIFO_SIZE){
+		++fifoOverflows;
+		resetFifo();
+		return 0;
+	}
+	unsigned int blocks = count / fifoSampleSize;
+	uint_fast64_t now = hwlib::now_us();
+	byte data[FIFO_BURST_SAMPLES * BURST_SIZE];
+	unsigned int done = 0;
+	while(done < blocks){
+		unsigned int burst = blocks - done > FIFO_BURST_SAMPLES ? FIFO_BURST_SAMPLES : blocks - done;
+		readRegisters(MPU6050_FIFO_R_W, data, burst * fifoSampleSize);
+		for(unsigned int i = 0; i < burst; i++){
+			mpuSample sample;
+			decodeFifoSample(data + i * fifoSampleSize, sample);
+			sample.timestamp = now - uint_fast64_t(blocks - 1 - (done + i)) * fifoSamplePeriodUs;
+			fifoSamples.push(sample);
+		}
+		done += burst;
+	}
+	return blocks;
+}
+
+unsigned int MPU6050::getFifoOverflows(){
+	return fifoOverflows;
+}
+
+sampleRingBuffer<MPU6050::FIFO_BUFFER_SIZE> & MPU6050::getFifoSamples(){
+	return fifoSamples;
+}
+
+// The INT pin goes high when one of the sources fires and stays high until
+// INT_STATUS is read.
+void MPU6050::enableInterrupt(const byte & sources){
+	interruptSources = sources;
+	writeRegister(MPU6050_INT_PIN_CFG, INT_PIN_CFG_LATCH);
+	writeRegister(MPU6050_INT_ENABLE, sources);
+}
+
+// The motion detector compares against the accelerometer value held by the
+// high pass filter. The filter is reset first, so the reference is the
+// current position, and then held. MOT_THR is in 2 mg steps, MOT_DUR in ms.
+// Only the motion interrupt is enabled, the sources set with
+// enableInterrupt() are kept for exitLowPower().
+void MPU6050::enableMotionInterrupt(const uint16_t & thresholdMg, const byte & durationMs){
+	uint16_t threshold = thresholdMg / 2;
+	if(threshold < 1){
+		threshold = 1;
+	}else if(threshold > 255){
+		threshold = 255;
+	}
+	byte range = fullScaleAccelRange << 3;
+	writeRegister(MPU6050_ACCEL_CONFIG, range);
+	writeRegister(MPU6050_MOT_THR, threshold);
+	writeRegister(MPU6050_MOT_DUR, durationMs);
+	writeRegister(MPU6050_MOT_DETECT_CTRL, 0);
+	writeRegister(MPU6050_INT_PIN_CFG, INT_PIN_CFG_LATCH);
+	writeRegister(MPU6050_INT_ENABLE, INT_MOTION);
+	hwlib::wait_ms(1);
+	writeRegister(MPU6050_ACCEL_CONFIG, range | ACCEL_HPF_HOLD);
+	getInterruptStatus();
+}
+
+// Gyro in standby, temperature sensor off and the accelerometer waking up
+// at the given rate for one sample. The internal oscillator is the only
+// clock that keeps running in cycle mode.
+void MPU6050::enterLowPower(const mpuWakeRate & rate){
+	writeRegister(MPU6050_PWR_MGMT_2, (byte(rate) << 6) | PWR_MGMT_2_STBY_GYRO);
+	writeRegister(MPU6050_PWR_MGMT_1, PWR_MGMT_1_CYCLE | PWR_MGMT_1_TEMP_DIS);
+	lowPower = true;
+}
+
+// Back to the configured clock with all sensors on, the high pass filter
+// released and the motion interrupt replaced by the sources that were set
+// with enableInterrupt() before.
+void MPU6050::exitLowPower(){
+	writeRegister(MPU6050_PWR_MGMT_1, byte(config.clock) & 0x07);
+	writeRegister(MPU6050_PWR_MGMT_2, 0);
+	writeRegister(MPU6050_ACCEL_CONFIG, fullScaleAccelRange << 3);
+	writeRegister(MPU6050_INT_ENABLE, interruptSources);
+	getInterruptStatus();
+	lowPower = false;
+}
+
+bool MPU6050::isLowPower(){
+	return lowPower;
+}
+
+byte MPU6050::getInterruptStatus(){
+	return read8bit(MPU6050_INT_STATUS);
+}
+
+void MPU6050::getSample(mpuSample & sample){
+	sample.accelX = accelX;
+	sample.accelY = accelY;
+	sample.accelZ = accelZ;
+	sample.temperature = temperature;
+	sample.gyroX = gyroX;
+	sample.gyroY = gyroY;
+	sample.gyroZ = gyroZ;
 }
\ No newline at end of file
@@ -1,13 +1,16 @@
 #ifndef MPU6050_HPP
 #define MPU6050_HPP
 #include "hwlib.hpp"
+#include "mpuSample.hpp"
+#include "mpuConfig.hpp"
+#include "i2cRegisterBus.hpp"
 
 #define byte uint8_t
 using byte_array = byte[8];
 
 class MPU6050{
 private:
-	hwlib::i2c_bus_bit_banged_scl_sda i2c_bus;
+	i2cRegisterBus & i2c_bus;
 	using byte_array = byte[8];
 	
 	const byte arraySize8 = 8;
@@ -21,18 +24,18 @@ private:
 	int16_t temperatureInCelcius;
 	
 	//Offset
-	uint16_t offsetAccelX, offsetAccelY, offsetAccelZ;
-	uint16_t offsetGyroX, offsetGyroY, offsetGyroZ;
+	mpuCalibration calibration = {};
 	
-	//Readable values
-	double gForceX, gForceY, gForceZ;
-	double rotX, rotY, rotZ;
+	//Copy of the configuration registers, so reading it needs no bus traffic
+	mpuConfig config;
+	byte fullScaleAccelRange = 0;
+	byte fullScaleGyroRange = 0;
 	
-	byte fullScaleAccelRange;
-	byte fullScaleGyroRange;
+	//Unit per LSB in Q16: milli-g for accel, milli-degrees/s for gyro
+	int32_t accelScaleQ16 = 4000;
+	int32_t gyroScaleQ16 = 500275;
 	
-	double gyroSensitivity;
-	double accelSensitivity;
+	void setScale();
 	
 	//MPU6050 Registers
 	//MPU addresses
@@ -65,6 +68,11 @@ private:
 	const byte MPU6050_GYRO_CONFIG 	= 0x1B;
 	const byte MPU6050_ACCEL_CONFIG	= 0x1C;
 	
+	//Motion detection
+	const byte MPU6050_MOT_THR		= 0x1F;
+	const byte MPU6050_MOT_DUR		= 0x20;
+	const byte MPU6050_MOT_DETECT_CTRL	= 0x69;
+	
 	//FIFO buffer
 	const byte MPU6050_FIFO_EN		= 0x23;
 	
@@ -175,8 +183,57 @@ private:
 	
 	//Identity
 	const byte MPU6050_WHO_AM_I		= 0x75; 
+	
+	//Burst read from ACCEL_XOUT_H up to and including GYRO_ZOUT_L
+	static const byte BURST_SIZE = 14;
+	
+	//FIFO control bits
+	const byte USER_CTRL_FIFO_EN	= 0x40;
+	const byte USER_CTRL_FIFO_RESET	= 0x04;
+	const byte INT_STATUS_FIFO_OFLOW	= 0x10;
+	
+	//Interrupt pin: active high, push-pull, held until INT_STATUS is read
+	const byte INT_PIN_CFG_LATCH	= 0x20;
+	
+	//Low power cycle mode bits
+	const byte PWR_MGMT_1_CYCLE		= 0x20;
+	const byte PWR_MGMT_1_TEMP_DIS	= 0x08;
+	const byte PWR_MGMT_2_STBY_GYRO	= 0x07;
+	//ACCEL_CONFIG high pass filter: hold the reference for motion detection
+	const byte ACCEL_HPF_HOLD		= 0x07;
+	bool lowPower = false;
+	//Sources set with enableInterrupt(), restored by exitLowPower()
+	byte interruptSources = 0;
+	static const uint16_t FIFO_SIZE	= 1024;
+	static const unsigned int FIFO_BURST_SAMPLES	= 16;
+	static const unsigned int FIFO_BUFFER_SIZE	= 32;
+	
+	//FIFO state
+	byte fifoSensors = 0;
+	byte fifoSampleSize = 0;
+	uint32_t fifoSamplePeriodUs = 1000;
+	unsigned int fifoOverflows = 0;
+	sampleRingBuffer<FIFO_BUFFER_SIZE> fifoSamples;
+	
+	void writeRegister(const byte & address, const byte & data);
+	void resetFifo();
+	void decodeFifoSample(const byte data[], mpuSample & sample);
+	
+	void decodeAccel(const byte data[]);
+	void decodeTemp(const byte data[]);
+	void decodeGyro(const byte data[]);
 public:
-	MPU6050(hwlib::i2c_bus_bit_banged_scl_sda & i2c_bus, const byte address = 0x68):
+	//Sensors for enableFifo, or'ed together
+	static const byte FIFO_TEMP		= 0x80;
+	static const byte FIFO_GYRO		= 0x70;
+	static const byte FIFO_ACCEL	= 0x08;
+	
+	//Interrupt sources for enableInterrupt, or'ed together
+	static const byte INT_DATA_READY	= 0x01;
+	static const byte INT_FIFO_OVERFLOW	= 0x10;
+	static const byte INT_MOTION	= 0x40;
+	
+	MPU6050(i2cRegisterBus & i2c_bus, const byte address = 0x68):
 		i2c_bus(i2c_bus),
 		deviceAddress(address)
 	{};
@@ -184,9 +241,10 @@ public:
 	int whoAmI();
 	void wakeUp();
 	byte read8bit(const byte & address);
-	int16_t read16bit(const byte & addressHigh, const byte & addressLow);
+	int16_t read16bit(const byte & addressHigh);
+	void readRegisters(const byte & startAddress, byte data[], const size_t & count);
 	
-	void calibrate();
+	bool calibrate(const uint32_t & timeoutMs = 2000);
 	
 	//Temperature
 	void setTemp();
@@ -195,11 +253,27 @@ public:
 	
 	// Gyro ranges
 	void setFullScaleGyroRange(byte range);
-	double getFullScaleGyroRange();
+	byte getFullScaleGyroRange();
 	
 	// Accel ranges
 	void setFullScaleAccelRange(byte range);
-	double getFullScaleAccelRange();
+	byte getFullScaleAccelRange();
+	
+	// Configuration, getters use the cached copy
+	void configure(const mpuConfig & newConfig);
+	mpuConfig getConfig();
+	void setDlpf(const mpuDlpf & dlpf);
+	mpuDlpf getDlpf();
+	void setSampleRateDivider(const byte & divider);
+	byte getSampleRateDivider();
+	void setClockSource(const mpuClock & clock);
+	mpuClock getClockSource();
+	uint32_t getGyroRateHz();
+	uint32_t getSampleRateHz();
+	
+	// Fixed-point conversion
+	void scale(const mpuSample & raw, mpuScaledSample & scaled);
+	void getScaledSample(mpuScaledSample & scaled);
 	
 	void setAccelGyro();
 	void setAccel();
@@ -218,13 +292,36 @@ public:
 	int16_t getGyroY();
 	int16_t getGyroZ();
 	
-	uint16_t getOffsetAccelX();
-	uint16_t getOffsetAccelY();
-	uint16_t getOffsetAccelZ();
-	
-	uint16_t getOffsetGyroX();
-	uint16_t getOffsetGyroY();
-	uint16_t getOffsetGyroZ();
+	int16_t getOffsetAccelX();
+	int16_t getOffsetAccelY();
+	int16_t getOffsetAccelZ();
+	
+	int16_t getOffsetGyroX();
+	int16_t getOffsetGyroY();
+	int16_t getOffsetGyroZ();
+	
+	mpuCalibration getCalibration();
+	void setCalibration(const mpuCalibration & newCalibration);
+	
+	//FIFO streaming
+	void enableFifo(const byte & sensors, const byte & sampleRateDivider);
+	void disableFifo();
+	uint16_t getFifoCount();
+	unsigned int drainFifo();
+	unsigned int drainFifo(const byte & status);
+	unsigned int getFifoOverflows();
+	sampleRingBuffer<FIFO_BUFFER_SIZE> & getFifoSamples();
+	
+	//Low power, wake on motion
+	void enableMotionInterrupt(const uint16_t & thresholdMg, const byte & durationMs);
+	void enterLowPower(const mpuWakeRate & rate);
+	void exitLowPower();
+	bool isLowPower();
+	
+	//Interrupts
+	void enableInterrupt(const byte & sources);
+	byte getInterruptStatus();
+	void getSample(mpuSample & sample);
 };
 
 #endif // MPU6050_HPP
@@ -0,0 +1,92 @@
+#ifndef ACTIONSCHEDULER_HPP
+#define ACTIONSCHEDULER_HPP
+#include "hwlib.hpp"
+#include "menuItem.hpp"
+
+namespace lightMenu{
+	/// @file
+
+	/// \brief
+	/// Runs the action of a selected menuItem one step at a time
+	/// \details
+	/// When a baseMenu has a scheduler, select() starts the action of the item
+	/// here instead of calling run(). An action that is not done after start()
+	/// is stepped by every tick() until step() returns false or it is
+	/// cancelled. Only one action runs at a time, selecting while an action
+	/// runs does nothing.
+class actionScheduler{
+	
+private:
+	menuItem * running = NULL;
+	unsigned int finished = 0;
+public:
+
+	/// \brief
+	/// Starts the action of the given item
+	/// \details
+	/// Returns false when another action is still running.
+	bool start(menuItem * item){
+		if(running != NULL || item == NULL){
+			return false;
+		}
+		if(item->start()){
+			running = item;
+		}else{
+			finished++;
+		}
+		return true;
+	}
+
+	/// \brief
+	/// Advances the running action one step
+	/// \details
+	/// Returns true as long as the action is still running.
+	bool tick(){
+		if(running == NULL){
+			return false;
+		}
+		if(!running->step()){
+			running = NULL;
+			finished++;
+		}
+		return running != NULL;
+	}
+
+	/// \brief
+	/// Cancels the running action, if any
+	void cancel(){
+		if(running != NULL){
+			running->cancel();
+			running = NULL;
+			finished++;
+		}
+	}
+
+	/// \brief
+	/// Returns whether an action is running
+	bool isBusy() const{
+		return running != NULL;
+	}
+
+	/// \brief
+	/// Returns the item whose action is running, NULL when idle
+	menuItem * getRunning(){
+		return running;
+	}
+
+	/// \brief
+	/// Returns the progress of the running action in percent, 0 when idle
+	unsigned int getProgress() const{
+		return running != NULL ? running->getProgress() : 0;
+	}
+
+	/// \brief
+	/// Returns how many actions have finished or were cancelled
+	/// \details
+	/// A change tells a display that an action ended since it last looked.
+	unsigned int getFinished() const{
+		return finished;
+	}
+};
+}
+#endif // ACTIONSCHEDULER_HPP
@@ -18,6 +18,8 @@
 
 #include <array>
 #include "menu.hpp"
+#include "actionScheduler.hpp"
+#include "navigableMenu.hpp"
 
 namespace lightMenu{
 	
@@ -30,12 +32,15 @@ namespace lightMenu{
 	/// Since baseMenu saves Menu's it makes multidimensional menu's possible.
 	///
 	/// Basemenu is a templated class because the heap is not usable and the used array's are of variable size wich is set at compile time.
-template<int t, int u> class baseMenu {
+template<int t, int u> class baseMenu : public navigableMenu {
 
 	private:
 		std::array<menu<u>*, t> & menus;
+		unsigned int menuCount = 0;
 		unsigned int currentMenuIndex = 0;
 		unsigned int cursorPosition = 0;
+		actionScheduler * scheduler = NULL;
+		menuLabel fallbackLabel;
 
 	public:
 		
@@ -47,6 +52,7 @@ template<int t, int u> class baseMenu {
 			for(unsigned int i = 0; i < menus.size(); i++){
 				if(menus[i] != NULL){
 					menus[i]->setBaseMenuPosition(i);
+					menuCount++;
 				}
 			}
 		}
@@ -72,7 +78,7 @@ template<int t, int u> class baseMenu {
 		/// returns the current value cursorPosition
 		/// \details
 		/// returns the current value of cursorPosition as an unsigned integer
-		unsigned int getCurrentCursorPos(){
+		unsigned int getCurrentCursorPos() override{
 			return cursorPosition;
 		}
 		
@@ -80,8 +86,8 @@ template<int t, int u> class baseMenu {
 		/// set cursorPosition to given value
 		/// \details
 		/// set cursorPosition to the given unsigned integer while taking the menu size limit into account.
-		void setCursorPos(unsigned int i){
-			if(getCurrentMenuSize() >= i){
+		void setCursorPos(unsigned int i) override{
+			if(i < getCurrentMenuSize()){
 				cursorPosition = i;
 			}
 		}
@@ -90,16 +96,39 @@ template<int t, int u> class baseMenu {
 		/// returns the currently selected menu size
 		/// \brief
 		/// returns the currenctly selected menu size using the currentMenuIndex and a pointer to the currently selected menu.
-		unsigned int getCurrentMenuSize(){
+		unsigned int getCurrentMenuSize() override{
 			return menus[currentMenuIndex]->getMenuItemArraySize();
 		}
 		
+		/// \brief
+		/// returns the index of the current menu in the menus array
+		unsigned int getCurrentMenuId() override{
+			return currentMenuIndex;
+		}
+		
+		/// \brief
+		/// returns the label of a menuItem of the current menu
+		/// \details
+		/// The revision is the revision of the menuItem. An item without a label from the menuLabelPool is rendered into a label of the baseMenu.
+		const menuLabel * getLabel(const unsigned int & index, unsigned int & revision) override{
+			menuItem * item = getCurrentMenu()->getMenuItemByIndex(index);
+			if(item == NULL){
+				return NULL;
+			}
+			revision = item->getRevision();
+			if(item->getLabel() != NULL){
+				return item->getLabel();
+			}
+			fallbackLabel.render(item->getName());
+			return &fallbackLabel;
+		}
+		
 		/// \brief
 		/// Decreases the value of cursor position.
 		/// \details
 		/// Decreases the value of cursor position but not below 0.
 		/// Since the menu items will probably be displayed from 0 untill the end of the array, the cursor needs to decrease to move the cursor up visually.
-		void cursorUp(){
+		void cursorUp() override{
 			if(cursorPosition > 0){
 				cursorPosition--;
 			}
@@ -110,8 +139,8 @@ template<int t, int u> class baseMenu {
 		/// \details
 		/// Increases the value of cursor position but not above the current menu size.
 		/// Since the menu items will probably be displayed from 0 untill the end of the array, the cursor needs to Increases to move the cursor down visually.
-		void cursorDown(){
-			if(cursorPosition < getCurrentMenuSize() -1){
+		void cursorDown() override{
+			if(cursorPosition + 1 < getCurrentMenuSize()){
 				cursorPosition++;
 			}
 		}
@@ -120,8 +149,22 @@ template<int t, int u> class baseMenu {
 		/// Executes the currently selected menuitem.
 		/// \details
 		/// Executes the currently selected menuItem, using the menu pointer of the current menu and the cursor position variable.
-		void select(){
-			getCurrentMenu()->getMenuItemByIndex(cursorPosition)->run();
+		/// With a scheduler set the action of the item is started on the scheduler instead, a long action then runs while the menu keeps going.
+		void select() override{
+			menuItem* item = getCurrentMenu()->getMenuItemByIndex(cursorPosition);
+			if(item == NULL){
+				return;
+			}
+			if(scheduler != NULL){
+				scheduler->start(item);
+			}else{
+				item->run();
+			}
+		}
+		/// \brief
+		/// Sets the scheduler that select() starts actions on, NULL runs them directly
+		void setScheduler(actionScheduler * newScheduler) override{
+			scheduler = newScheduler;
 		}
 		
 		/// \brief
@@ -142,7 +185,7 @@ template<int t, int u> class baseMenu {
 		/// Set the new menu to the parent menu of the current menu.
 		/// \brief
 		/// Set the new menu to the parent menu of the current menu and resetting the cursor.
-		void previousMenu(){
+		void previousMenu() override{
 			currentMenuIndex = getCurrentMenu()->getParentMenuPosition();
 			cursorPosition = 0;
 		}
@@ -159,14 +202,27 @@ template<int t, int u> class baseMenu {
 		/// \brief
 		/// Adds a new menu to the menus array.
 		/// \details
-		/// Adds a new menu to the menus array while also making sure it does not overload the array and setting a new baseMenuPosition to the newly added menu.
-		void addMenu(menu<u>* menu){
+		/// Adds a new menu to the first free position of the menus array and sets its baseMenuPosition.
+		/// Returns false if the array is full, the menu is then not added.
+		bool addMenu(menu<u>* menu){
+			if(menu == NULL || menuCount >= menus.size()){
+				return false;
+			}
 			for(unsigned int i = 0; i < menus.size(); i++ ){
 				if(menus[i] == NULL){
 					menus[i] = menu;
 					menus[i]->setBaseMenuPosition(i);
+					menuCount++;
+					return true;
 				}
 			}
+			return false;
+		}
+		
+		/// \brief
+		/// Returns the number of menus in the menus array.
+		unsigned int getMenuCount(){
+			return menuCount;
 		}
 };
 }
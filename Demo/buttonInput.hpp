@@ -0,0 +1,154 @@
+#ifndef BUTTONINPUT_HPP
+#define BUTTONINPUT_HPP
+#include "hwlib.hpp"
+
+/// \brief
+/// Something that happened to a button
+/// \details
+/// REPEAT follows a PRESS at the auto-repeat rate while the button is held,
+/// LONG_PRESS is sent once when it is held longer than the long press time.
+struct buttonEvent{
+	enum class type { PRESS, RELEASE, REPEAT, LONG_PRESS };
+	unsigned int button;
+	type kind;
+	uint_fast64_t timestamp;
+};
+
+/// \brief
+/// Debounces one active high button and turns it into events
+/// \details
+/// A change of the pin is reported at once, after which the pin is ignored
+/// for debounceUs, so the bounces that follow an edge are not seen. Press
+/// latency is one poll, not the debounce time.
+class debouncedButton{
+private:
+	hwlib::pin_in * pin = nullptr;
+	bool pressed = false;
+	bool longSent = false;
+	uint_fast64_t lastChange = 0;
+	uint_fast64_t nextRepeat = 0;
+	
+public:
+	uint_fast64_t debounceUs = 10000;
+	uint_fast64_t repeatDelayUs = 500000; // 0 = no auto-repeat
+	uint_fast64_t repeatPeriodUs = 150000;
+	uint_fast64_t longPressUs = 1000000; // 0 = no long press
+	
+	void setPin(hwlib::pin_in & newPin){
+		pin = &newPin;
+	}
+	
+	/// \brief
+	/// Samples the pin, returns true and fills event if something happened
+	bool update(const uint_fast64_t & now, buttonEvent & event){
+		if(pin == nullptr){
+			return false;
+		}
+		if(now - lastChange >= debounceUs){
+			bool level = pin->get();
+			if(level != pressed){
+				pressed = level;
+				lastChange = now;
+				longSent = false;
+				nextRepeat = now + repeatDelayUs;
+				event.kind = pressed ? buttonEvent::type::PRESS : buttonEvent::type::RELEASE;
+				event.timestamp = now;
+				return true;
+			}
+		}
+		if(!pressed){
+			return false;
+		}
+		if(longPressUs > 0 && !longSent && now - lastChange >= longPressUs){
+			longSent = true;
+			event.kind = buttonEvent::type::LONG_PRESS;
+			event.timestamp = now;
+			return true;
+		}
+		if(repeatDelayUs > 0 && now >= nextRepeat){
+			nextRepeat += repeatPeriodUs;
+			if(nextRepeat <= now){
+				nextRepeat = now + repeatPeriodUs;
+			}
+			event.kind = buttonEvent::type::REPEAT;
+			event.timestamp = now;
+			return true;
+		}
+		return false;
+	}
+	
+	bool isPressed(){
+		return pressed;
+	}
+};
+
+/// \brief
+/// Debounced buttons with a queue of their events
+/// \details
+/// update() samples every button and queues what happened, it never waits.
+/// The application takes the events with poll(). A full queue drops the
+/// newest events, getDropped() counts them.
+template<unsigned int n, unsigned int queueSize = 8>
+class buttonInput{
+private:
+	debouncedButton buttons[n];
+	buttonEvent events[queueSize];
+	unsigned int head = 0;
+	unsigned int count = 0;
+	unsigned int dropped = 0;
+	
+	void push(const buttonEvent & event){
+		if(count == queueSize){
+			++dropped;
+			return;
+		}
+		events[(head + count) % queueSize] = event;
+		++count;
+	}
+	
+public:
+	/// \brief
+	/// Connects button number to pin
+	void setPin(const unsigned int & button, hwlib::pin_in & pin){
+		if(button < n){
+			buttons[button].setPin(pin);
+		}
+	}
+	
+	/// \brief
+	/// Returns a button to change its debounce, repeat and long press times
+	debouncedButton & getButton(const unsigned int & button){
+		return buttons[button < n ? button : n - 1];
+	}
+	
+	/// \brief
+	/// Samples all buttons, call every tick
+	void update(){
+		uint_fast64_t now = hwlib::now_us();
+		buttonEvent event;
+		for(unsigned int i = 0; i < n; i++){
+			if(buttons[i].update(now, event)){
+				event.button = i;
+				push(event);
+			}
+		}
+	}
+	
+	/// \brief
+	/// Takes the oldest event, returns false if there is none
+	bool poll(buttonEvent & event){
+		if(count == 0){
+			return false;
+		}
+		event = events[head];
+		head = (head + 1) % queueSize;
+		--count;
+		return true;
+	}
+	
+	unsigned int getDropped(){
+		return dropped;
+	}
+};
+
+#endif // BUTTONINPUT_HPP
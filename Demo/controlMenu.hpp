@@ -18,7 +18,7 @@
 #define CONTROLMENU_HPP
 
 #include "hwlib.hpp"
-#include "baseMenu.hpp"
+#include "navigableMenu.hpp"
 
 namespace lightMenu{
 	/// @file
@@ -27,48 +27,49 @@ namespace lightMenu{
 	/// The controlMenu class provides a link between the by the user chosen controller and the menu.
 	/// \details
 	/// The controlMenu class provides a link between the by the user chosen controller and the menu, it displays all the possible functions a controller can do.
-template<int t, int u>
+	/// It controls a navigableMenu, so a baseMenu as well as a tableMenu.
 class controlMenu
 {
 
 protected:
-	baseMenu<t, u> & baseMenuRef;
+	navigableMenu & menuRef;
 
 public:
 	/// \brief
 	/// default constructor
-	controlMenu<t, u>(baseMenu<t, u> & baseMenuRef):
-	baseMenuRef(baseMenuRef)
+	controlMenu(navigableMenu & menuRef):
+	menuRef(menuRef)
 	{}
 
 	/// \brief
-	/// Executes the cursorUp function in the baseMenu class.
+	/// Executes the cursorUp function in the menu.
 	void cursorUp(){
-		baseMenuRef.cursorUp();
+		menuRef.cursorUp();
 	}
 	
 	/// \brief
-	/// Executes the cursorDown function in the baseMenu class.
+	/// Executes the cursorDown function in the menu.
 	void cursorDown(){
-		baseMenuRef.cursorDown();
+		menuRef.cursorDown();
 	}
 	
 	/// \brief
-	/// Executes the select function in the baseMenu class.
+	/// Executes the select function in the menu.
 	void select(){
-		baseMenuRef.select();
+		menuRef.select();
 	}
 	
 	/// \brief
-	/// Executes the previousMenu function in the baseMenu class.
+	/// Executes the previousMenu function in the menu.
 	void previousMenu(){
-		baseMenuRef.previousMenu();
+		menuRef.previousMenu();
 	}
 	
 	/// \brief
-	/// executes the previousMenu function in the basemenu class with unsigned integer.
+	/// executes the previousMenu function in the menu and sets the cursor to the given position.
 	void previousMenu(unsigned int i){
-		baseMenuRef.previousMenu(i);
+		menuRef.previousMenu();
+		menuRef.setCursorPos(i);
 	}
 };
 }
@@ -17,7 +17,7 @@
 #ifndef DISPLAYMENU_HPP
 #define DISPLAYMENU_HPP
 
-#include "baseMenu.hpp"
+#include "navigableMenu.hpp"
 
 namespace lightMenu{
 	/// @file
@@ -26,16 +26,16 @@ namespace lightMenu{
 	/// The displayMenu is the abstract class that the user can extend to display the menu on the preffered display
 	/// \details
 	/// The displayMenu is the abstract class that sets some guidelines for the making of a display specific display driver.
-template<int t, int u>
+	/// It shows a navigableMenu, so a baseMenu as well as a tableMenu.
 class displayMenu
 {
 protected:
-	baseMenu<t, u> & baseMenuRef;
+	navigableMenu & menuRef;
 	public:
 	/// \brief
 	/// default constructor
-	displayMenu<t, u>(baseMenu<t, u> & baseMenuRef):
-	baseMenuRef(baseMenuRef)
+	displayMenu(navigableMenu & menuRef):
+	menuRef(menuRef)
 	{}
 
 	/// \brief
@@ -45,6 +45,12 @@ protected:
 	/// \brief
 	/// A virtual class to profide guidelines for the child class
 	virtual void clear() = 0;
+	
+	/// \brief
+	/// Forgets what was drawn, the next draw() repaints everything
+	/// \details
+	/// Needed after something else drew on the display, like a menu action.
+	virtual void invalidate(){}
 };
 }
 #endif // DISPLAYMENU_HPP
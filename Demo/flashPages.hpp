@@ -0,0 +1,36 @@
+#ifndef FLASHPAGES_HPP
+#define FLASHPAGES_HPP
+#include "hwlib.hpp"
+
+/// \brief
+/// A few pages of flash memory to keep settings in
+/// \details
+/// Pages are numbered from 0 to getPageCount() - 1 and are PAGE_SIZE bytes.
+/// Like NOR flash, program() can only clear bits: a byte that is already
+/// programmed keeps its value when 0xFF is written over it, so a page can be
+/// filled in parts. eraseAndProgram() sets the whole page to 0xFF first.
+///
+/// sam3xFlashPages is the internal flash of the SAM3X8E, the tests use a
+/// file backed stand-in.
+class flashPages{
+public:
+	static const unsigned int PAGE_SIZE = 256;
+	
+	/// \brief
+	/// Returns the number of pages
+	virtual unsigned int getPageCount() const = 0;
+	
+	/// \brief
+	/// Reads a whole page
+	virtual void read(const unsigned int & page, uint8_t data[PAGE_SIZE]) = 0;
+	
+	/// \brief
+	/// Programs a page without erasing it, returns false on an error
+	virtual bool program(const unsigned int & page, const uint8_t data[PAGE_SIZE]) = 0;
+	
+	/// \brief
+	/// Erases a page and programs it, returns false on an error
+	virtual bool eraseAndProgram(const unsigned int & page, const uint8_t data[PAGE_SIZE]) = 0;
+};
+
+#endif // FLASHPAGES_HPP
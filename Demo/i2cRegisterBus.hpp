@@ -0,0 +1,38 @@
+#ifndef I2CREGISTERBUS_HPP
+#define I2CREGISTERBUS_HPP
+#include "hwlib.hpp"
+
+/// \brief
+/// I2C bus that can read registers of a device
+/// \details
+/// readRegisters() writes the register address and reads count bytes from
+/// there. By default that is a write and a separate read; a bus that can do
+/// it with a repeated start, like the SAM3X TWI, overrides it.
+class i2cRegisterBus : public hwlib::i2c_bus{
+public:
+	virtual void readRegisters(uint_fast8_t address, uint8_t startRegister, uint8_t data[], size_t count){
+		write(address, &startRegister, 1);
+		read(address, data, count);
+	}
+};
+
+/// \brief
+/// Makes any hwlib::i2c_bus, for example the bit banged one, an i2cRegisterBus
+class i2cRegisterBusAdapter : public i2cRegisterBus{
+private:
+	hwlib::i2c_bus & bus;
+public:
+	i2cRegisterBusAdapter(hwlib::i2c_bus & bus):
+		bus(bus)
+	{}
+	
+	void write(uint_fast8_t address, const uint8_t data[], size_t count) override {
+		bus.write(address, data, count);
+	}
+	
+	void read(uint_fast8_t address, uint8_t data[], size_t count) override {
+		bus.read(address, data, count);
+	}
+};
+
+#endif // I2CREGISTERBUS_HPP
@@ -0,0 +1,205 @@
+#ifndef LEDMATRIXMENU_HPP
+#define LEDMATRIXMENU_HPP
+#include "hwlib.hpp"
+#include "lightMenu.hpp"
+#include "../../max7219.hpp"
+
+/// \brief
+/// Shows the selected menu entry on a chain of max7219 led matrices
+/// \details
+/// The label of the selected entry, rendered in the 8x8 font by the menu,
+/// is drawn with the first letter on screen n like setWord(). A name wider
+/// than the chain scrolls as a marquee. When the cursor or menu changes, the
+/// old name slides out and the new one slides in vertically, in the
+/// direction the cursor moved.
+///
+/// Everything is drawn into the ledMatrixSet buffer with blit() and sent with
+/// flush(), so a step only costs a frame per changed row, no matter how long
+/// the chain is. update() runs the marquee and transitions and has to be
+/// called every tick of the main loop.
+template<unsigned int n>
+class ledMatrixMenu : public lightMenu::displayMenu
+{
+	static const unsigned int ROWS = 8;
+	static const unsigned int WIDTH = n * 8;
+	//Columns of space between the end and the start of a scrolling name
+	static const unsigned int MARQUEE_GAP = 16;
+	//Modules per blit, the sprite width is 8 bits
+	static const unsigned int BLIT_MODULES = 16;
+	
+	max7219::ledMatrixSet<n> & matrices;
+	lightMenu::menuLabel label;
+	const lightMenu::menuLabel * shownLabel = NULL;
+	unsigned int shownRevision = 0;
+	unsigned int shownCursor = 0;
+	unsigned int shownMenu = 0;
+	bool valid = false;
+	
+	uint8_t shown[ROWS][n];
+	uint8_t previous[ROWS][n];
+	unsigned int transitionStep = 0;
+	bool transitionDown = true;
+	unsigned int marqueeOffset = 0;
+	uint_fast64_t stepUs;
+	uint_fast64_t lastStep = 0;
+	
+	/// \brief
+	/// Renders the name at the marquee offset into rows
+	/// \details
+	/// Visual column c, counted from the left, is pixel WIDTH - 1 - c of the
+	/// chain: screen n is on the left and bit 7 is the left column of a screen.
+	void render(uint8_t rows[ROWS][n]){
+		unsigned int textWidth = label.width;
+		bool scrolling = textWidth > WIDTH;
+		unsigned int period = textWidth + MARQUEE_GAP;
+		for(unsigned int row = 0; row < ROWS; row++){
+			for(unsigned int m = 0; m < n; m++){
+				rows[row][m] = 0;
+			}
+			for(unsigned int c = 0; c < WIDTH; c++){
+				unsigned int column = scrolling ? (c + marqueeOffset) % period : c;
+				if(label.getPixel(column, row)){
+					unsigned int x = WIDTH - 1 - c;
+					rows[row][x / 8] |= 1 << (x % 8);
+				}
+			}
+		}
+	}
+	
+	/// \brief
+	/// Draws rows into the buffer and flushes the changed digits
+	void show(const uint8_t rows[ROWS][n]){
+		uint8_t chunk[ROWS * BLIT_MODULES];
+		for(unsigned int first = 0; first < n; first += BLIT_MODULES){
+			unsigned int modules = n - first > BLIT_MODULES ? BLIT_MODULES : n - first;
+			for(unsigned int row = 0; row < ROWS; row++){
+				for(unsigned int m = 0; m < modules; m++){
+					chunk[row * modules + m] = rows[row][first + m];
+				}
+			}
+			const max7219::sprite image = {chunk, uint8_t(modules * 8), ROWS};
+			matrices.blit(image, first * 8, 0, max7219::rasterOp::COPY);
+		}
+		matrices.flush();
+		for(unsigned int row = 0; row < ROWS; row++){
+			for(unsigned int m = 0; m < n; m++){
+				shown[row][m] = rows[row][m];
+			}
+		}
+	}
+	
+	/// \brief
+	/// Draws the current frame of the transition or marquee
+	/// \details
+	/// A transition takes ROWS frames: ROWS - 1 frames in which the names
+	/// are mixed and one frame with only the new name.
+	void step(){
+		uint8_t rows[ROWS][n];
+		render(rows);
+		if(transitionStep > 1){
+			// transitionStep runs from ROWS down to 2: rows of the new name
+			// that have moved in so far
+			unsigned int in = ROWS + 1 - transitionStep;
+			uint8_t mixed[ROWS][n];
+			for(unsigned int row = 0; row < ROWS; row++){
+				for(unsigned int m = 0; m < n; m++){
+					if(transitionDown){
+						mixed[row][m] = row + in < ROWS ? previous[row + in][m] : rows[row + in - ROWS][m];
+					}else{
+						mixed[row][m] = row >= in ? previous[row - in][m] : rows[ROWS - in + row][m];
+					}
+				}
+			}
+			show(mixed);
+			--transitionStep;
+			return;
+		}
+		transitionStep = 0;
+		show(rows);
+	}
+	
+public:
+	/// \brief
+	/// Constructs the menu display, stepUs is the time per marquee or
+	/// transition step
+	ledMatrixMenu(lightMenu::navigableMenu & menu, max7219::ledMatrixSet<n> & matrices, const uint_fast64_t & stepUs = 40000):
+		lightMenu::displayMenu(menu),
+		matrices(matrices),
+		stepUs(stepUs)
+	{
+		for(unsigned int row = 0; row < ROWS; row++){
+			for(unsigned int m = 0; m < n; m++){
+				shown[row][m] = 0;
+			}
+		}
+	}
+	
+	/// \brief
+	/// Picks up a change of cursor or menu and starts its transition
+	void draw() override{
+		unsigned int cursor = menuRef.getCurrentCursorPos();
+		unsigned int menuIndex = menuRef.getCurrentMenuId();
+		unsigned int revision = 0;
+		const lightMenu::menuLabel * current = menuRef.getLabel(cursor, revision);
+		if(valid && cursor == shownCursor && menuIndex == shownMenu && current == shownLabel && revision == shownRevision){
+			return;
+		}
+		bool animate = valid;
+		transitionDown = !valid || menuIndex != shownMenu || cursor > shownCursor;
+		shownCursor = cursor;
+		shownMenu = menuIndex;
+		shownLabel = current;
+		shownRevision = revision;
+		valid = true;
+		
+		label.width = 0;
+		if(current != NULL){
+			label = *current;
+		}
+		for(unsigned int row = 0; row < ROWS; row++){
+			for(unsigned int m = 0; m < n; m++){
+				previous[row][m] = shown[row][m];
+			}
+		}
+		marqueeOffset = 0;
+		transitionStep = animate ? ROWS : 0;
+		lastStep = hwlib::now_us();
+		step();
+	}
+	
+	/// \brief
+	/// Advances the marquee and transitions, call every tick
+	void update(){
+		if(!valid){
+			return;
+		}
+		uint_fast64_t now = hwlib::now_us();
+		if(now - lastStep < stepUs){
+			return;
+		}
+		lastStep = now;
+		if(transitionStep > 0){
+			step();
+		}else if(label.width > WIDTH){
+			marqueeOffset = (marqueeOffset + 1) % (label.width + MARQUEE_GAP);
+			step();
+		}
+	}
+	
+	/// \brief
+	/// Forgets what is shown, the next draw() draws the name again
+	/// \details
+	/// Needed when something else drew on the chain in between.
+	void invalidate() override{
+		valid = false;
+		transitionStep = 0;
+	}
+	
+	void clear() override{
+		uint8_t rows[ROWS][n] = {};
+		show(rows);
+		invalidate();
+	}
+};
+
+#endif // LEDMATRIXMENU_HPP
@@ -18,9 +18,12 @@
 #include "baseMenu.hpp"
 #include "menu.hpp"
 #include "menuItem.hpp"
+#include "actionScheduler.hpp"
+#include "navigableMenu.hpp"
 #include "MenuItemMenuLink.hpp"
 #include "controlMenu.hpp"
 #include "displayMenu.hpp"
 #include "previousMenuMenuItem.hpp"
+#include "menuTable.hpp"
 
 #endif // LIGHTMENU_HPP
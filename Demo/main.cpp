@@ -16,23 +16,84 @@
 #include "../../max7219.hpp"
 #include <stdlib.h>
 #include "MPU6050.hpp"
+#include "mpuCalibrator.hpp"
+#include "mpuDataReady.hpp"
+#include "sam3xTwiBus.hpp"
+#include "sam3xFlashPages.hpp"
+#include "settingsStore.hpp"
+#include "motionWake.hpp"
 #include "lightMenu.hpp"
 #include "oledmenu.hpp"
+#include "ledMatrixMenu.hpp"
 #include "menuController.hpp"
+#include "runLoop.hpp"
+#include "tracer.hpp"
+
+// keys and versions of what the demo keeps in the settings store
+enum settingKey : uint8_t { SETTING_DIFFICULTY = 1, SETTING_CALIBRATION = 2 };
+const uint8_t DIFFICULTY_VERSION = 1;
+const uint8_t CALIBRATION_VERSION = 1;
+
+// the menu tree: the game and the difficulties are actions, an index in the
+// array of menu items given to the tableMenu
+enum menuAction : unsigned int { ACTION_GAME, ACTION_EASY, ACTION_MEDIUM, ACTION_HARD, ACTION_COUNT };
+constexpr lightMenu::menuEntry menuOutline[] = {
+	{"Settings", 0, lightMenu::MENU_SUBMENU},
+	{"Beginner", 1, ACTION_EASY},
+	{"Gevorderd", 1, ACTION_MEDIUM},
+	{"Expert", 1, ACTION_HARD},
+	{"Terug", 1, lightMenu::MENU_BACK},
+	{"Start game", 0, ACTION_GAME}
+};
+// computed by the compiler, so the layout is a constant in flash
+constexpr auto menuLayout = lightMenu::makeMenuTable(menuOutline);
+
+struct difficultySetting{
+	int32_t gameWait;
+	int32_t gapWidth;
+};
 
 class gameControl : public lightMenu::menuItem{
 	private:
+		/// \brief
+		/// Where the game is, every state ends with a wait
+		enum class gameState { FALL, SCROLL, END, SHOW_GAME, SHOW_OVER, SHOW_SCORE, DONE };
+		static const unsigned int n = 4;
+		
 		hwlib::target::pin_in calibrationButton;
 		hwlib::window_ostream screen;
-		MPU6050 mpu;
+		MPU6050 & mpu;
+		mpuDataReady & sensor;
+		max7219::ledMatrixSet<4> & matrices;
 		int gameWait;
 		int gapWidth;
+		gameState state = gameState::DONE;
+		uint_fast64_t wakeUs = 0;
+		int posX = 0;
+		int posY = 0;
+		int i = 0;
+		int j = 0;
+		tracer * trace = NULL;
+		bool dumpTrace = false;
+		int spanTick = -1;
+		int spanSensor = -1;
+		int spanCompose = -1;
+		int spanFlush = -1;
+		int spanScroll = -1;
+		int spanOled = -1;
+		int spanPhoton = -1;
+		
+		void waitMs(const int & ms){
+			wakeUs = hwlib::now_us() + uint_fast64_t(ms) * 1000;
+		}
 	public:
-		gameControl(hwlib::string<0> name, hwlib::target::pin_in & calibrationButton, hwlib::window_ostream & screen, MPU6050 & mpu, const int & tmpGameWait, const int & tmpGapWidth):
+		gameControl(hwlib::string<0> name, hwlib::target::pin_in & calibrationButton, hwlib::window_ostream & screen, MPU6050 & mpu, mpuDataReady & sensor, max7219::ledMatrixSet<4> & matrices, const int & tmpGameWait, const int & tmpGapWidth):
 			lightMenu::menuItem(name),
 			calibrationButton(calibrationButton),
 			screen(screen),
 			mpu(mpu),
+			sensor(sensor),
+			matrices(matrices),
 			gameWait(tmpGameWait),
 			gapWidth(tmpGapWidth)
 		{}
@@ -63,21 +124,133 @@ class gameControl : public lightMenu::menuItem{
 		void setGapWidth(const int & tmpGapWidth){
 			gapWidth = tmpGapWidth;
 		}
+		
+		// times the parts of the game, the statistics are printed after
+		// every game
+		void setTracer(tracer * newTrace){
+			trace = newTrace;
+			if(trace != NULL){
+				spanTick = trace->addSpan("game tick");
+				spanSensor = trace->addSpan("sensor read");
+				spanCompose = trace->addSpan("compose");
+				spanFlush = trace->addSpan("led flush");
+				spanScroll = trace->addSpan("wall scroll");
+				spanOled = trace->addSpan("oled flush");
+				spanPhoton = trace->addSpan("sample to led");
+			}
+		}
 
+		// plays a whole game, for use without an actionScheduler
 		void run(){
+			if(start()){
+				while(step()){}
+			}
+		}
+		
+		bool start() override{
+			// started from the menu while everything was asleep
+			if(mpu.isLowPower()){
+				mpu.exitLowPower();
+			}
+			sensor.begin();
 			calibrate();
-			int score = startGame();
-			hwlib::cout << score << '\n';
-			
-			screen 
-				<< "\f" << "Je hebt: "   
-				<< "\t0302" << score
-				<< "\n" << "punten behaald."
-				<< hwlib::flush;
-			
-			hwlib::wait_ms(2500);
-			
-			screen << hwlib::flush;
+			matrices.resetRegisters();
+			matrices.setCycle(false);
+			posX = n*8;
+			posY = 4;
+			i = 0;
+			j = 0;
+			hwlib::cout << "gametime\n";
+			hwlib::cout << "GameWait: " << gameWait << "\n";
+			hwlib::cout << "GapWidth: " << gapWidth << "\n";
+			state = gameState::FALL;
+			waitMs(1500);
+			return true;
+		}
+		
+		// one move of the ball or one scroll of the walls per call
+		bool step() override{
+			if(hwlib::now_us() < wakeUs){
+				return true;
+			}
+			bool running;
+			{
+				traceScope tick(trace, spanTick);
+				running = advance();
+			}
+			// dumped after the tick is timed, so the slow serial output
+			// does not end up in the statistics of the next game
+			if(dumpTrace){
+				dumpTrace = false;
+				trace->dump(hwlib::cout);
+				trace->clear();
+			}
+			return running;
+		}
+		
+		// does the work of the current state, returns false when done
+		bool advance(){
+			switch(state){
+				case gameState::FALL:
+					moveBall();
+					j++;
+					if(j == 4){
+						j = 0;
+						state = gameState::SCROLL;
+					}else{
+						waitMs(gameWait);
+					}
+					return true;
+				case gameState::SCROLL:
+					state = scroll() ? gameState::FALL : gameState::END;
+					waitMs(gameWait);
+					return true;
+				case gameState::END:
+					matrices.resetRegisters();
+					state = gameState::SHOW_GAME;
+					waitMs(500);
+					return true;
+				case gameState::SHOW_GAME:
+					matrices.setCycleDelay(150*60000);
+					matrices.setLetter(4, 'G');
+					matrices.setLetter(3, 'a');
+					matrices.setLetter(2, 'm');
+					matrices.setLetter(1, 'e');
+					state = gameState::SHOW_OVER;
+					waitMs(1500);
+					return true;
+				case gameState::SHOW_OVER:
+					matrices.setLetter(4, 'O');
+					matrices.setLetter(3, 'v');
+					matrices.setLetter(2, 'e');
+					matrices.setLetter(1, 'r');
+					state = gameState::SHOW_SCORE;
+					waitMs(1500);
+					return true;
+				case gameState::SHOW_SCORE:
+					matrices.resetRegisters();
+					hwlib::cout << i << '\n';
+					{
+						traceScope oled(trace, spanOled);
+						screen 
+							<< "\f" << "Je hebt: "   
+							<< "\t0302" << i
+							<< "\n" << "punten behaald."
+							<< hwlib::flush;
+					}
+					dumpTrace = trace != NULL;
+					state = gameState::DONE;
+					waitMs(2500);
+					return true;
+				case gameState::DONE:
+					break;
+			}
+			return false;
+		}
+		
+		void cancel() override{
+			matrices.resetRegisters();
+			state = gameState::DONE;
 		}
 		
 		void calibrate(){
@@ -85,123 +258,100 @@ class gameControl : public lightMenu::menuItem{
 			srand(mpu.getAccelX());
 		}
 		
-		int startGame(){
-			// max7219 led matrices
-			const unsigned int n = 4;
-			auto din     = hwlib::target::pin_out(hwlib::target::pins::d51);
-			auto cs      = hwlib::target::pin_out(hwlib::target::pins::d47);
-			auto clk     = hwlib::target::pin_out(hwlib::target::pins::d45);
-			auto csInv   = max7219::pin_out_invert(cs);
-			auto spi_bus = max7219::spiBusLed(clk, din, csInv, hwlib::pin_in_dummy);
-			max7219::ledMatrixSet<n> matrices(spi_bus);
-			matrices.resetRegisters();
-			matrices.setCycle(false);
+		void moveBall(){
+			const uint8_t ballLine = 0x01;
+			const uint8_t noBallLine = 0x00;
+			const max7219::sprite ball = {&ballLine, 1, 1};
+			const max7219::sprite noBall = {&noBallLine, 1, 1};
 			
-			int posX = n*8;
-			int posY = 4;
 			int previousPosX = posX;
 			int previousPosY = posY;
+			uint32_t sampleStart = tracer::now();
+			// the sensor is only read when its INT pin says there is a new
+			// sample, otherwise the previous sample is used again
+			mpuScaledSample motion;
+			{
+				traceScope read(trace, spanSensor);
+				sensor.update();
+				mpuSample raw;
+				sensor.getLatest(raw);
+				mpu.scale(raw, motion);
+			}
+
+			int posXMod = 0;
+			if(matrices.getPixel(posX-2, posY-1)){
+				posXMod = 0;
+			}else{
+				posXMod = -1; // gravity pulling it down once
+			}
+			posX += posXMod;
+			if(posX <1){
+				posX = 1;
+			}
 			
-			hwlib::wait_ms(1500);
-			hwlib::cout << "gametime\n";
-			hwlib::cout << "GameWait: " << gameWait << "\n";
-			hwlib::cout << "GapWidth: " << gapWidth << "\n";
+			int32_t turn = motion.accelZ; // milli-g
+//			hwlib::cout << int(turn) << '\n';
+			int posYMod = 0;
+			if(turn > 300){
+				posYMod -= 1;
+			}
+			if(turn < -300){
+				posYMod += 1;
+			}
+			
+			// boundaries
+			posY += posYMod;
+			if(posY > 8){
+				posY = 8;
+			}else if(posY < 1){
+				posY = 1;
+			}
+			
+			//falling, the ball is erased and drawn in the buffer and
+			//only the changed collumns are sent
+			{
+				traceScope compose(trace, spanCompose);
+				matrices.blit(noBall, previousPosX-1, previousPosY-1, max7219::rasterOp::COPY);
+				matrices.blit(ball, posX-1, posY-1);
+			}
+			{
+				traceScope flush(trace, spanFlush);
+				matrices.flush();
+			}
+			if(trace != NULL){
+				trace->end(spanPhoton, sampleStart);
+			}
+		}
+		
+		// scrolls the walls one step, returns false when the ball hit a wall
+		bool scroll(){
 			bool game = true;
-			int i = 0;
-			while(game){
-				int j = 0;
-				bool player = true;
-				while(player){
-					previousPosX = posX;
-					previousPosY = posY;
-					mpu.setAccelGyro();
-
-					int posXMod = 0;
-					if((((matrices.getLedMatrix(calculateScreenN(posX-1)).getLatchedValue(posY)&255) >> (calculateCoordData(posX-1)-1)) & 1) == 1){
-						posXMod = 0;
-					}else{
-						posXMod = -1; // gravity pulling it down once
-					}
-					posX += posXMod;
-					if(posX <1){
-						posX = 1;
-					}
-					
-					int16_t turn = mpu.getAccelZ();
-//					hwlib::cout << int(turn) << '\n';
-					int posYMod = 0;
-					if(turn > 5000){
-						posYMod -= 1;
-					}
-					if(turn < -5000){
-						posYMod += 1;
-					}
-					
-					// boundaries
-					posY += posYMod;
-					if(posY > 8){
-						posY = 8;
-					}else if(posY < 1){
-						posY = 1;
-					}
-					
-					//falling 
-					unsigned int screenN = calculateScreenN(posX);
-					uint8_t coordData = calculateCoordData(posX);
-					
-					matrices.resetLedAt(calculateScreenN(previousPosX), previousPosY, calculateCoordData(previousPosX));
-					matrices.setLed(screenN, posY, coordData, true);
-					
-					j++;
-					if(j == 4){
-						player = false;
-					}else{
-						hwlib::wait_ms(gameWait);
-					}
-				}
-
-				uint8_t row = 0;
-				if(i%4 == 0){
-					row = (255 ^ gapWidth << rand()%8);
-				}
-				unsigned int screenN = calculateScreenN(posX);
-				max7219::ledMatrix currentLed = matrices.getLedMatrix(screenN);
-				uint16_t collumn = currentLed.getLatchedValue(posY);
-				uint8_t coordData = calculateCoordData(posX);
-				//If coords are same as row, game over
-				if((((collumn & 255) >> (coordData-1))&1) == 1 && posX == n*8){
-					game = false;
-				}
+			uint8_t row = 0;
+			if(i%4 == 0){
+				row = (255 ^ gapWidth << rand()%8);
+			}
+			unsigned int screenN = calculateScreenN(posX);
+			max7219::ledMatrix currentLed = matrices.getLedMatrix(screenN);
+			uint16_t collumn = currentLed.getLatchedValue(posY);
+			uint8_t coordData = calculateCoordData(posX);
+			//If coords are same as row, game over
+			if((((collumn & 255) >> (coordData-1))&1) == 1 && posX == n*8){
+				game = false;
+			}
 
-					
-				if(posX >= int(n*8)){
-					posX = n*8;
-				}else{
-					posX += 1;
-				}
+				
+			if(posX >= int(n*8)){
+				posX = n*8;
+			}else{
+				posX += 1;
+			}
+			{
+				traceScope walls(trace, spanScroll);
 				matrices.cycleSteps(1);
 				matrices.setRow(1, row);
-				hwlib::wait_ms(gameWait);
-				i++;
 			}
-			matrices.resetRegisters();
-			
-			hwlib::wait_ms(500);
-			matrices.setCycleDelay(150*60000);
-			matrices.setLetter(4, 'G');
-			matrices.setLetter(3, 'a');
-			matrices.setLetter(2, 'm');
-			matrices.setLetter(1, 'e');
-			hwlib::wait_ms(1500);
-			matrices.setLetter(4, 'O');
-			matrices.setLetter(3, 'v');
-			matrices.setLetter(2, 'e');
-			matrices.setLetter(1, 'r');
-			hwlib::wait_ms(1500);
-			
-			matrices.resetRegisters();
-			
-			return i;
+			i++;
+			return game;
 		}
 	
 };
@@ -209,12 +359,14 @@ class gameControl : public lightMenu::menuItem{
 class difficultyControl : public lightMenu::menuItem{
 	private:
 		gameControl *game;
+		settingsStore & store;
 		int gameWait;
 		int gapWidth;
 	public:
-		difficultyControl(hwlib::string<0> name, gameControl * game, const int & tmpGameWait, const int & tmpGapwidth):
+		difficultyControl(hwlib::string<0> name, gameControl * game, settingsStore & store, const int & tmpGameWait, const int & tmpGapwidth):
 			lightMenu::menuItem(name),
 			game(game),
+			store(store),
 			gameWait(tmpGameWait),
 			gapWidth(tmpGapwidth)
 		{}
@@ -222,19 +374,84 @@ class difficultyControl : public lightMenu::menuItem{
 		void run(){
 			game->setGameWait(gameWait);
 			game->setGapWidth(gapWidth);
-			setName(getName() << "!");
+			// one record appended, the choice is back after a reset
+			if(!store.set(SETTING_DIFFICULTY, DIFFICULTY_VERSION, difficultySetting{gameWait, gapWidth})){
+				hwlib::cout << "difficulty not saved\n";
+			}
+			hwlib::string<lightMenu::menuLabel::CHARACTERS> newName;
+			newName << getName() << "!";
+			setName(newName);
 		}
 	
 };
 
+// the background work of the demo, done every tick of the run loop
+class backgroundTask : public tickTask{
+	private:
+		motionWake<4> & idle;
+		mpuCalibrator & calibrator;
+		MPU6050 & mpu;
+		mpuDataReady & sensor;
+		uint32_t calibratorSequence = 0;
+		settingsStore & store;
+		bool calibrationStored;
+		bool calibrationTried = false;
+		ledMatrixMenu<4> & ledMenu;
+		lightMenu::actionScheduler & scheduler;
+	public:
+		backgroundTask(motionWake<4> & idle, mpuCalibrator & calibrator, MPU6050 & mpu, mpuDataReady & sensor, settingsStore & store, const bool & calibrationStored, ledMatrixMenu<4> & ledMenu, lightMenu::actionScheduler & scheduler):
+			idle(idle),
+			calibrator(calibrator),
+			mpu(mpu),
+			sensor(sensor),
+			store(store),
+			calibrationStored(calibrationStored),
+			ledMenu(ledMenu),
+			scheduler(scheduler)
+		{}
+		
+		void tick(const bool & active) override{
+			if(active){
+				idle.touch();
+			}
+			idle.update();
+			if(!idle.isSleeping()){
+				// the calibrator gets every new sample the sensor publishes,
+				// also the ones the game read, and never reads the MPU6050
+				// itself
+				sensor.update();
+				mpuSample sample;
+				uint32_t sequence = sensor.getLatest(sample);
+				bool calibrated = calibrator.isCalibrated();
+				if(sequence != calibratorSequence){
+					calibratorSequence = sequence;
+					calibrated = calibrator.feed(sample);
+				}
+				// the first complete calibration is kept for the next boot;
+				// a write that fails is not tried again until the next boot,
+				// every try can cost a page erase and program
+				if(calibrated && !calibrationStored && !calibrationTried){
+					calibrationTried = true;
+					calibrationStored = store.set(SETTING_CALIBRATION, CALIBRATION_VERSION, mpu.getCalibration());
+					if(!calibrationStored){
+						hwlib::cout << "calibration not saved\n";
+					}
+				}
+				// the game owns the matrices while it runs
+				if(!scheduler.isBusy()){
+					ledMenu.update();
+				}
+			}
+		}
+};
+
 int main(){
 	// kill the watchdog
 	WDT->WDT_MR = WDT_MR_WDDIS;
 	hwlib::wait_ms(1000);
 	
-	auto scl = hwlib::target::pin_oc( hwlib::target::pins::scl1 );
-	auto sda = hwlib::target::pin_oc( hwlib::target::pins::sda1 );
-	auto i2c_bus = hwlib::i2c_bus_bit_banged_scl_sda( scl, sda );
+	// OLED on SDA1/SCL1, driven by the TWI0 peripheral at 400 kHz
+	sam3xTwiBus i2c_bus(sam3xTwiBus::peripheral::TWI_0);
 	auto displayOled = hwlib::glcd_oled( i2c_bus, 0x3c ); 
 	
 	
@@ -246,12 +463,52 @@ int main(){
 	auto buttonDown = hwlib::target::pin_in(hwlib::target::pins::d31);
 	
 	// MPU6050 (gyroscope/accelerator)
-	auto sclGyro = hwlib::target::pin_oc(hwlib::target::pins::scl);
-	auto sdaGyro = hwlib::target::pin_oc(hwlib::target::pins::sda);
-	auto i2c_bus_Mpu6050 = hwlib::i2c_bus_bit_banged_scl_sda(sclGyro, sdaGyro);
+	sam3xTwiBus i2c_bus_Mpu6050(sam3xTwiBus::peripheral::TWI_1);
 	auto mpu = MPU6050(i2c_bus_Mpu6050); 
 	mpu.wakeUp();
+	// 100 Hz samples with a 44 Hz bandwidth, plenty for steering the ball
+	mpuConfig mpuSettings;
+	mpuSettings.clock = mpuClock::PLL_XGYRO;
+	mpuSettings.dlpf = mpuDlpf::BW_44HZ;
+	mpuSettings.sampleRateDivider = 9;
+	mpu.configure(mpuSettings);
 	mpu.setAccelGyro();
+	// the INT pin of the MPU6050 tells the game when a new sample is ready
+	auto mpuInt = hwlib::target::pin_in(hwlib::target::pins::d43);
+	mpuDataReady sensor(mpu, mpuInt);
+	sensor.begin();
+	
+	// max7219 led matrices
+	auto din     = hwlib::target::pin_out(hwlib::target::pins::d51);
+	auto cs      = hwlib::target::pin_out(hwlib::target::pins::d47);
+	auto clk     = hwlib::target::pin_out(hwlib::target::pins::d45);
+	auto csInv   = max7219::pin_out_invert(cs);
+	auto spi_bus = max7219::spiBusLed(clk, din, csInv, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<4> matrices(spi_bus);
+	matrices.resetRegisters();
+	
+	// after 30 seconds without buttons the leds fade out and shut down and
+	// the MPU6050 goes to low power, moving the device wakes both up
+	max7219::powerManager<4> power(matrices);
+	power.setIdleTimeout(30000000, 20000);
+	motionWake<4> idle(mpu, power);
+	
+	// settings in the last flash pages: the difficulty and the calibration
+	sam3xFlashPages flash;
+	settingsStore store(flash);
+	store.load();
+	
+	// calibrates while the menu is in use, then keeps tracking the gyro bias;
+	// a stored calibration is used right away
+	mpuCalibrator calibrator(mpu);
+	mpuCalibration storedCalibration;
+	bool calibrationStored = store.get(SETTING_CALIBRATION, CALIBRATION_VERSION, storedCalibration);
+	if(calibrationStored){
+		mpu.setCalibration(storedCalibration);
+		calibrator.track();
+	}else{
+		calibrator.start();
+	}
 
 	
 	hwlib::string<9> gameEasy;
@@ -263,48 +520,47 @@ int main(){
 	hwlib::string<7> gameHard;
 	gameHard.clear() << "Expert";
 	
-	hwlib::string<9> settings;
-	settings.clear() << "Settings";
-	
 	hwlib::string<11> startGame;
 	startGame.clear() << "Start game";
 	
-	hwlib::string<6> back;
-	back.clear() << "Terug";
-	
-	
-	gameControl game(startGame, buttonSelect, display, mpu, 50, 3);
-	difficultyControl easy(gameEasy, &game, 200, 7);
-	difficultyControl medium(gameMedium, &game, 50, 3);
-	difficultyControl hard(gameHard, &game, 10, 1);
 	
-	std::array<lightMenu::menuItem*, 4> settingsMenuArray = {&easy, &medium, &hard};
-	std::array<lightMenu::menuItem*, 4> mainMenuArray = {};
-	
-	lightMenu::menu<4> mainMenu(mainMenuArray);
-	lightMenu::menu<4> settingsMenu(settingsMenuArray, &mainMenu);
-	
-	std::array<lightMenu::menu<4>*, 2>menuArrayTest = {&mainMenu, &settingsMenu};
-	lightMenu::baseMenu<2, 4> basisMenu(menuArrayTest);
+	gameControl game(startGame, buttonSelect, display, mpu, sensor, matrices, 50, 3);
+	difficultyControl easy(gameEasy, &game, store, 200, 7);
+	difficultyControl medium(gameMedium, &game, store, 50, 3);
+	difficultyControl hard(gameHard, &game, store, 10, 1);
+	difficultySetting difficulty;
+	if(store.get(SETTING_DIFFICULTY, DIFFICULTY_VERSION, difficulty)){
+		game.setGameWait(difficulty.gameWait);
+		game.setGapWidth(difficulty.gapWidth);
+	}
 	
-	auto oled = oledMenu<2, 4>(basisMenu, displayOled, 5);
+	std::array<lightMenu::menuItem*, ACTION_COUNT> actions = {};
+	actions[ACTION_GAME] = &game;
+	actions[ACTION_EASY] = &easy;
+	actions[ACTION_MEDIUM] = &medium;
+	actions[ACTION_HARD] = &hard;
+	lightMenu::tableMenu<sizeof(menuOutline) / sizeof(menuOutline[0]), ACTION_COUNT> navigation(menuLayout, actions);
 	
-	auto menuControl = menuController<2, 4>(basisMenu, buttonUp, buttonSelect, buttonDown);
+	auto oled = oledMenu(navigation, displayOled, i2c_bus, 0x3c, 5);
 	
-	lightMenu::menuItemMenuLink<2,4> settingsMenuController(settings, settingsMenu, basisMenu);
+	// the selected item also scrolls by on the led matrices
+	ledMatrixMenu<4> ledMenu(navigation, matrices);
 	
-	lightMenu::previousMenuMenuItem<2, 4> backButton(back, basisMenu);
+	auto menuControl = menuController(navigation, buttonUp, buttonSelect, buttonDown);
 	
-	mainMenu.addMenuItem(&settingsMenuController);
-	mainMenu.addMenuItem(&game);
-	settingsMenu.addMenuItem(&backButton);
+	// the game runs one step per tick, the calibrator and the idle timeout
+	// keep going while it runs
+	lightMenu::actionScheduler scheduler;
+	runLoop<> loop(navigation, menuControl, scheduler);
 	
-	oled.draw();
-	for(;;){
-		if(menuControl.read()){
-			oled.draw();
-			hwlib::wait_ms(550);
-		}
-
-	}
-}
\ No newline at end of file
+	// the game and the menu are timed, the statistics go to the serial port
+	// after every game
+	tracer trace;
+	game.setTracer(&trace);
+	loop.setTracer(&trace);
+	backgroundTask background(idle, calibrator, mpu, sensor, store, calibrationStored, ledMenu, scheduler);
+	loop.addDisplay(&oled);
+	loop.addDisplay(&ledMenu);
+	loop.addTask(&background);
+	loop.run();
+}
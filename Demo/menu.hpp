@@ -28,14 +28,32 @@ namespace lightMenu{
 	/// Menu tracks it menu items which in turn have there own unique values.
 	/// Menu also keeps track of it's so called parent menu, the parent menu is the menu that is higher in the menu hierarchy.
 	/// The last thing menu keeps track of is it's own index in the basemenu which makes it easier to get and set menu's.
+	///
+	/// The items are kept together at the start of the array and their number is tracked, so the size is known without scanning the array.
 template<int t> class menu
 {
 	
 private:
 	std::array<menuItem*, t> menuItemArray;
+	unsigned int itemCount = 0;
 	unsigned int parentMenuPosition = 0;
 	unsigned int baseMenuPosition = 0;
 	
+	/// \brief
+	/// Moves the items to the start of the array and counts them
+	void compact(){
+		itemCount = 0;
+		for(unsigned int i = 0; i < menuItemArray.size(); i++){
+			if(menuItemArray[i] != NULL){
+				menuItemArray[itemCount] = menuItemArray[i];
+				itemCount++;
+			}
+		}
+		for(unsigned int i = itemCount; i < menuItemArray.size(); i++){
+			menuItemArray[i] = NULL;
+		}
+	}
+	
 public:
 	/// \brief
 	/// default empty constructor
@@ -47,11 +65,15 @@ public:
 	/// constructor with an by reference array of menuItems
 	menu<t>(const std::array<menuItem*, t> & menuItems):
 		menuItemArray( menuItems)
-	{}
+	{
+		compact();
+	}
 	
 	/// \brief
 	/// construct with a pointer to the parentMenu
-	menu<t>(menu<t> *parentMenu){
+	menu<t>(menu<t> *parentMenu):
+		menuItemArray()
+	{
 		parentMenuPosition = parentMenu->getBaseMenuPosition();
 	}
 	
@@ -60,14 +82,18 @@ public:
 	menu<t>(const std::array<menuItem*, t> & menuItems, menu<t> *parentMenu):
 		menuItemArray( menuItems )
 		{
+		compact();
 		parentMenuPosition = parentMenu->getBaseMenuPosition();
 		}
 	
 	/// \brief
 	/// Get menuItem by reference
 	/// \details
-	/// Returns the pointer of a menu item that is selected by the given integer index.
+	/// Returns the pointer of a menu item that is selected by the given integer index, NULL if there is no item at that index.
 	menuItem* getMenuItemByIndex(int index){
+		if(index < 0 || unsigned(index) >= itemCount){
+			return NULL;
+		}
 		return menuItemArray[index];
 	}
 	
@@ -94,29 +120,59 @@ public:
 	/// \brief
 	/// Returns the used array size as unsigned integer.
 	/// \details
-	/// Returns the size of the used positions in the array by checking if a position is not null.
+	/// Returns the number of items in the menu, which is tracked when items are added and removed.
 	unsigned int getMenuItemArraySize(){
-		unsigned int count = 0;
-		for(unsigned int i = 0; i <= menuItemArray.max_size() -1; i++ ){
-			if(menuItemArray[i] != NULL){
-				count++;
-			}
-		}
-		return count;
+		return itemCount;
 	}
 	
 	/// \brief
 	/// Add a menuItem by pointer.
 	/// \details
-	/// Add a menuItem to the menuItemArray on the first position that is null in the array.
-	/// If the array is empty no item is added.
-	void addMenuItem(menuItem* item){
-		for(unsigned int i = 0; i <= menuItemArray.max_size()-1; i++ ){
-			if(menuItemArray[i] == NULL){
-				menuItemArray[i] = item;
-				break;
-			}
+	/// Add a menuItem after the last item in the menu.
+	/// If the array is full or the item is NULL no item is added and false is returned.
+	bool addMenuItem(menuItem* item){
+		if(item == NULL || itemCount >= menuItemArray.size()){
+			return false;
+		}
+		menuItemArray[itemCount] = item;
+		itemCount++;
+		return true;
+	}
+	
+	/// \brief
+	/// Insert a menuItem at the given index.
+	/// \details
+	/// The items from the index on move one place up. An index past the last item adds the item at the end.
+	/// If the array is full or the item is NULL no item is inserted and false is returned.
+	bool insertMenuItem(unsigned int index, menuItem* item){
+		if(item == NULL || itemCount >= menuItemArray.size()){
+			return false;
+		}
+		if(index > itemCount){
+			index = itemCount;
+		}
+		for(unsigned int i = itemCount; i > index; i--){
+			menuItemArray[i] = menuItemArray[i - 1];
+		}
+		menuItemArray[index] = item;
+		itemCount++;
+		return true;
+	}
+	
+	/// \brief
+	/// Remove the menuItem at the given index.
+	/// \details
+	/// The items after the index move one place down, so the items stay together. Returns false if there is no item at the index.
+	bool removeMenuItem(unsigned int index){
+		if(index >= itemCount){
+			return false;
+		}
+		for(unsigned int i = index; i + 1 < itemCount; i++){
+			menuItemArray[i] = menuItemArray[i + 1];
 		}
+		itemCount--;
+		menuItemArray[itemCount] = NULL;
+		return true;
 	}
 	
 };
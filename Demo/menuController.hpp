@@ -2,38 +2,98 @@
 #define MENUCONTROLLER_HPP
 #include "hwlib.hpp"
 #include "lightMenu.hpp"
+#include "buttonInput.hpp"
 
-template<int t, int u>
-class menuController : public lightMenu::controlMenu<t, u>
+/// \brief
+/// Controls the menu with an up, select and down button
+/// \details
+/// The buttons are debounced by a buttonInput. Up and down move the cursor
+/// on a press and keep moving it at the auto-repeat rate while held, select
+/// acts on the press only. While a menu action runs readCancel() takes the
+/// place of read(): holding select cancels the action. Only a press that
+/// began while the action runs counts, the press that started the action
+/// can be held without cancelling it.
+class menuController : public lightMenu::controlMenu
 {
-	hwlib::target::pin_in pinUp;
-	hwlib::target::pin_in pinRight;
-	hwlib::target::pin_in pinDown;
+	enum { BUTTON_UP, BUTTON_SELECT, BUTTON_DOWN, BUTTON_COUNT };
+	buttonInput<BUTTON_COUNT> input;
+	uint_fast64_t lastEventUs = 0;
+	bool cancelPressed = false;
 
 public:
-	menuController(lightMenu::baseMenu<t, u> & baseMenu, hwlib::target::pin_in & pinUp, hwlib::target::pin_in & pinRight, hwlib::target::pin_in & pinDown):
-		lightMenu::controlMenu<t, u> (baseMenu),
-		pinUp( pinUp ),
-		pinRight( pinRight ),
-		pinDown( pinDown )
-	{};
+	menuController(lightMenu::navigableMenu & menu, hwlib::target::pin_in & pinUp, hwlib::target::pin_in & pinRight, hwlib::target::pin_in & pinDown):
+		lightMenu::controlMenu (menu)
+	{
+		input.setPin(BUTTON_UP, pinUp);
+		input.setPin(BUTTON_SELECT, pinRight);
+		input.setPin(BUTTON_DOWN, pinDown);
+		input.getButton(BUTTON_SELECT).repeatDelayUs = 0;
+	};
+	
+	/// \brief
+	/// Handles the button events since the previous call, never waits
+	/// \details
+	/// Returns true if the menu changed or an item was selected.
 	bool read(){
-//		hwlib::cout << "pinUp : " << pinUp.get() << "\n";
-//		hwlib::cout << "pinDown : " << pinDown.get() << "\n";
-//		hwlib::cout << "pinRight : " << pinRight.get() << "\n";
-		if(pinUp.get() == 1){
-			lightMenu::controlMenu<t, u>::cursorUp();
-			return true;
-		}else if(pinDown.get() == 1){
-			lightMenu::controlMenu<t, u>::cursorDown();
-			return true;
-		}else if(pinRight.get() == 1){
-			lightMenu::controlMenu<t, u>::select();
-			return true;
-		}else{
-			return false;
+		input.update();
+		bool changed = false;
+		buttonEvent event;
+		while(input.poll(event)){
+			if(event.kind != buttonEvent::type::PRESS && event.kind != buttonEvent::type::REPEAT){
+				continue;
+			}
+			lastEventUs = event.timestamp;
+			if(event.button == BUTTON_UP){
+				cursorUp();
+				changed = true;
+			}else if(event.button == BUTTON_DOWN){
+				cursorDown();
+				changed = true;
+			}else if(event.button == BUTTON_SELECT && event.kind == buttonEvent::type::PRESS){
+				// a long press of this press must not cancel what it starts
+				cancelPressed = false;
+				select();
+				changed = true;
+			}
 		}
+		return changed;
+	}
+	
+	/// \brief
+	/// Handles the button events while a menu action runs, never waits
+	/// \details
+	/// The events do not move the cursor. Returns true when select was
+	/// pressed after the action started and then held for the long press
+	/// time.
+	bool readCancel(){
+		input.update();
+		bool cancel = false;
+		buttonEvent event;
+		while(input.poll(event)){
+			if(event.button != BUTTON_SELECT){
+				continue;
+			}
+			if(event.kind == buttonEvent::type::PRESS){
+				cancelPressed = true;
+			}else if(event.kind == buttonEvent::type::LONG_PRESS && cancelPressed){
+				cancelPressed = false;
+				cancel = true;
+			}
+		}
+		return cancel;
+	}
+	
+	/// \brief
+	/// Returns the time of the last button event read() acted on, in us
+	uint_fast64_t getLastEventUs(){
+		return lastEventUs;
+	}
+	
+	/// \brief
+	/// Returns the input, to tune debounce and repeat times
+	buttonInput<BUTTON_COUNT> & getInput(){
+		return input;
 	}
 };
 
-#endif // MENUCONTROLLER_HPP
\ No newline at end of file
+#endif // MENUCONTROLLER_HPP
@@ -17,6 +17,7 @@
 #define MENUITEM_HPP
 #include "hwlib.hpp"
 #include <functional>
+#include "menuLabel.hpp"
 
 namespace lightMenu{
 	/// @file
@@ -29,29 +30,112 @@ class menuItem{
 	
 private:
 	hwlib::string<0> name;
+	menuLabel * label;
+	unsigned int revision = 0;
+
+	/// \brief
+	/// Renders the name into the label, if there is one
+	void renderLabel(){
+		if(label != NULL){
+			label->render(name);
+		}
+	}
 public:
 
 	/// \brief
 	/// Default constructor
+	/// \details
+	/// Takes a label from the menuLabelPool and renders the name into it.
 	menuItem(hwlib::string<0> name):
-	name( name )
-	{}
+	name( name ),
+	label( menuLabelPool::get().allocate() )
+	{
+		renderLabel();
+	}
+
+	/// \brief
+	/// Copy constructor, the copy gets a label of its own
+	menuItem(const menuItem & other):
+	name( other.name ),
+	label( menuLabelPool::get().allocate() )
+	{
+		renderLabel();
+	}
+
+	menuItem & operator=(const menuItem & other){
+		setName(other.name);
+		return *this;
+	}
+
+	/// \brief
+	/// Gives the label back to the pool
+	virtual ~menuItem(){
+		menuLabelPool::get().release(label);
+	}
 	
 	/// \brief
 	/// Returns the name
 	/// \details
-	/// Returns the name as an hwlib string.
-	hwlib::string<0> getName(){
+	/// Returns a reference to the name, it changes when setName is called.
+	const hwlib::string<0> & getName() const{
 		return name;
 	}
 
+	/// \brief
+	/// Returns the rendered name
+	/// \details
+	/// Returns NULL when the menuLabelPool was empty when this item was made,
+	/// the display has to render getName() itself then.
+	const menuLabel * getLabel() const{
+		return label;
+	}
+
+	/// \brief
+	/// Returns a number that changes every time the name changes
+	/// \details
+	/// Displays compare it to the revision they drew to see if a line is out of date.
+	unsigned int getRevision() const{
+		return revision;
+	}
+
 	/// \brief
 	/// Set name
 	/// \details
-	/// Set name to given string by clearing the previous and setting the new name.
-	void setName(hwlib::string<0> newName){
-		hwlib::cout << "string change" << '\n';
+	/// Set name to given string by clearing the previous and setting the new name, the label is rendered again.
+	void setName(const hwlib::string<0> & newName){
 		name.clear() << newName;
+		renderLabel();
+		revision++;
+	}
+
+	/// \brief
+	/// Starts the action of this item
+	/// \details
+	/// Called by the actionScheduler when the item is selected. Returns true
+	/// when the action is not done yet and step() has to be called. The
+	/// default runs run() to the end and returns false.
+	virtual bool start(){
+		run();
+		return false;
+	}
+
+	/// \brief
+	/// Does one step of the action, returns false when it is done
+	/// \details
+	/// A step should return quickly, waits are done by returning true until
+	/// the time has passed.
+	virtual bool step(){
+		return false;
+	}
+
+	/// \brief
+	/// Stops the action before it is done
+	virtual void cancel(){}
+
+	/// \brief
+	/// Returns the progress of the action in percent, 0 when unknown
+	virtual unsigned int getProgress() const{
+		return 0;
 	}
 
 	/// \brief
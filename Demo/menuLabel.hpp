@@ -0,0 +1,130 @@
+#ifndef MENULABEL_HPP
+#define MENULABEL_HPP
+#include "hwlib.hpp"
+
+namespace lightMenu{
+	/// @file
+
+	/// \brief
+	/// A menu item name rendered in the 8x8 font
+	/// \details
+	/// Every byte is one pixel column of the name, bit 0 is the top row. This
+	/// is the page layout of an SSD1306 OLED, so a label can be sent to it as
+	/// it is. width is the number of columns in use, 8 per character.
+	struct menuLabel{
+		static const unsigned int CHARACTERS = 16;
+		static const unsigned int COLUMNS = CHARACTERS * 8;
+
+		uint8_t columns[COLUMNS];
+		uint8_t width;
+
+		/// \brief
+		/// Renders the given name, characters beyond CHARACTERS are dropped
+		void render(const hwlib::string<0> & name){
+			hwlib::font_default_8x8 font;
+			unsigned int characters = name.length() < CHARACTERS ? name.length() : CHARACTERS;
+			for(unsigned int c = 0; c < characters; c++){
+				renderCharacter(font, c, name[c]);
+			}
+			width = characters * 8;
+		}
+
+		/// \brief
+		/// Renders the given text, characters beyond CHARACTERS are dropped
+		void render(const char * text){
+			hwlib::font_default_8x8 font;
+			unsigned int characters = 0;
+			for(; text != NULL && text[characters] != '\0' && characters < CHARACTERS; characters++){
+				renderCharacter(font, characters, text[characters]);
+			}
+			width = characters * 8;
+		}
+
+		/// \brief
+		/// Renders one character at character position c
+		void renderCharacter(const hwlib::font_default_8x8 & font, const unsigned int & c, const char & character){
+			const hwlib::image & glyph = font[character];
+			for(int x = 0; x < 8; x++){
+				uint8_t column = 0;
+				for(int y = 0; y < 8; y++){
+					if(glyph[hwlib::location(x, y)] == hwlib::black){
+						column |= 1 << y;
+					}
+				}
+				columns[c * 8 + x] = column;
+			}
+		}
+
+		/// \brief
+		/// Returns whether the pixel at column x, row y is on
+		bool getPixel(const unsigned int & x, const unsigned int & y) const{
+			return x < width && ((columns[x] >> y) & 1);
+		}
+	};
+
+	/// \brief
+	/// Fixed pool of menu labels
+	/// \details
+	/// Menu items take a label from this pool when they are made and give it
+	/// back when they are destroyed, so no heap is used. When the pool is
+	/// empty allocate() returns NULL and the displays render that name
+	/// themselves. SLOTS labels take SLOTS * 129 bytes of RAM.
+	class menuLabelPool{
+	public:
+		static const unsigned int SLOTS = 16;
+	private:
+		union slot{
+			menuLabel label;
+			slot * next;
+		};
+		slot slots[SLOTS];
+		slot * freeList;
+		unsigned int used = 0;
+	public:
+		menuLabelPool(){
+			for(unsigned int i = 0; i + 1 < SLOTS; i++){
+				slots[i].next = &slots[i + 1];
+			}
+			slots[SLOTS - 1].next = NULL;
+			freeList = &slots[0];
+		}
+
+		/// \brief
+		/// Returns the pool shared by all menu items
+		static menuLabelPool & get(){
+			static menuLabelPool pool;
+			return pool;
+		}
+
+		/// \brief
+		/// Takes a label from the pool, NULL when the pool is empty
+		menuLabel * allocate(){
+			if(freeList == NULL){
+				return NULL;
+			}
+			slot * s = freeList;
+			freeList = s->next;
+			used++;
+			return &s->label;
+		}
+
+		/// \brief
+		/// Gives a label back to the pool, NULL is ignored
+		void release(menuLabel * label){
+			if(label == NULL){
+				return;
+			}
+			slot * s = reinterpret_cast<slot *>(label);
+			s->next = freeList;
+			freeList = s;
+			used--;
+		}
+
+		/// \brief
+		/// Returns the number of labels in use
+		unsigned int getUsed() const{
+			return used;
+		}
+	};
+}
+#endif // MENULABEL_HPP
@@ -0,0 +1,296 @@
+#ifndef MENUTABLE_HPP
+#define MENUTABLE_HPP
+
+#include <array>
+#include "menuItem.hpp"
+#include "navigableMenu.hpp"
+
+namespace lightMenu{
+	/// @file
+
+	/// \brief
+	/// Action value of a menuEntry that opens the entries below it as a menu.
+	static constexpr unsigned int MENU_SUBMENU = ~0u;
+	
+	/// \brief
+	/// Action value of a menuEntry that goes back to the parent menu.
+	static constexpr unsigned int MENU_BACK = ~0u - 1;
+
+	/// \brief
+	/// One line of a menu outline.
+	/// \details
+	/// The outline lists the whole menu tree from top to bottom, every entry with its depth: 0 for the top menu, 1 for the entries of a submenu of the top menu and so on.
+	/// The action is an index in the array of menuItems given to the tableMenu, or MENU_SUBMENU or MENU_BACK.
+struct menuEntry{
+	const char * label;
+	unsigned int depth;
+	unsigned int action;
+};
+
+	/// \brief
+	/// The layout of a menu tree, computed at compile time.
+	/// \details
+	/// The entries are reordered so the entries of every menu are next to each other, the top menu first.
+	/// For every entry the parent entry, the first child and the number of children are stored, so navigating is a table lookup.
+	/// A parent of n means the top menu.
+	///
+	/// Made with makeMenuTable from a constexpr outline, the table is a constant and stays in flash.
+template<unsigned int n>
+struct menuTable{
+	menuEntry entries[n];
+	unsigned int parent[n];
+	unsigned int firstChild[n];
+	unsigned int childCount[n];
+	unsigned int position[n];
+	unsigned int rootCount;
+};
+
+	/// \brief
+	/// Computes the menuTable for an outline.
+	/// \details
+	/// An entry belongs to the nearest entry above it that is one level less deep; an entry without one belongs to the top menu.
+	/// Usage:
+	/// \code
+	/// constexpr lightMenu::menuEntry outline[] = {
+	/// 	{"Start game", 0, 0},
+	/// 	{"Settings", 0, lightMenu::MENU_SUBMENU},
+	/// 	{"Beginner", 1, 1},
+	/// 	{"Terug", 1, lightMenu::MENU_BACK}
+	/// };
+	/// constexpr auto table = lightMenu::makeMenuTable(outline);
+	/// \endcode
+template<unsigned int n>
+constexpr menuTable<n> makeMenuTable(const menuEntry (&outline)[n]){
+	menuTable<n> table{};
+	unsigned int outlineParent[n] = {};
+	for(unsigned int i = 0; i < n; i++){
+		outlineParent[i] = n;
+		for(unsigned int j = i; j > 0; j--){
+			if(outline[j - 1].depth + 1 == outline[i].depth){
+				outlineParent[i] = j - 1;
+				break;
+			}
+			if(outline[j - 1].depth < outline[i].depth){
+				break;
+			}
+		}
+	}
+	
+	// menus in breadth first order, the children of each menu appended together
+	unsigned int tableIndex[n] = {};
+	unsigned int order[n] = {};
+	unsigned int placed = 0;
+	for(unsigned int i = 0; i < n; i++){
+		if(outlineParent[i] == n){
+			tableIndex[i] = placed;
+			order[placed++] = i;
+		}
+	}
+	table.rootCount = placed;
+	for(unsigned int next = 0; next < placed; next++){
+		unsigned int menuOutline = order[next];
+		unsigned int first = placed;
+		for(unsigned int i = 0; i < n; i++){
+			if(outlineParent[i] == menuOutline){
+				tableIndex[i] = placed;
+				order[placed++] = i;
+			}
+		}
+		table.firstChild[next] = first;
+		table.childCount[next] = placed - first;
+	}
+	
+	for(unsigned int t = 0; t < n; t++){
+		unsigned int i = order[t];
+		table.entries[t] = outline[i];
+		table.parent[t] = outlineParent[i] == n ? n : tableIndex[outlineParent[i]];
+	}
+	for(unsigned int t = 0; t < n; t++){
+		unsigned int first = table.parent[t] == n ? 0 : table.firstChild[table.parent[t]];
+		table.position[t] = t - first;
+	}
+	return table;
+}
+
+	/// \brief
+	/// Navigates a menuTable.
+	/// \details
+	/// Offers the same navigation as baseMenu, but on a constant menuTable: every operation is a table lookup and no menu objects or pointer arrays are needed in RAM.
+	/// Entries with an action index run the menuItem at that index of the actions array and show the label of that menuItem, so a renamed item shows its new name.
+	/// Submenu and back entries show the label from the table, rendered once into the menuLabelPool when the tableMenu is made.
+template<unsigned int n, unsigned int a>
+class tableMenu : public navigableMenu{
+	private:
+		const menuTable<n> & table;
+		const std::array<menuItem*, a> & actions;
+		unsigned int currentMenu = n;
+		unsigned int cursorPosition = 0;
+		actionScheduler * scheduler = NULL;
+		menuLabel * labels[n];
+		menuLabel fallbackLabel;
+		
+		unsigned int firstEntry(){
+			return currentMenu == n ? 0 : table.firstChild[currentMenu];
+		}
+		
+		/// \brief
+		/// returns the menuItem of a table entry, NULL for submenu and back entries
+		menuItem * getAction(const unsigned int & entry){
+			unsigned int action = table.entries[entry].action;
+			return action < a ? actions[action] : NULL;
+		}
+		
+	public:
+		/// \brief
+		/// Construct a tableMenu for a table and the menuItems its actions refer to
+		tableMenu(const menuTable<n> & table, const std::array<menuItem*, a> & actions):
+			table(table),
+			actions(actions)
+		{
+			for(unsigned int i = 0; i < n; i++){
+				labels[i] = NULL;
+				if(getAction(i) == NULL){
+					labels[i] = menuLabelPool::get().allocate();
+					if(labels[i] != NULL){
+						labels[i]->render(table.entries[i].label);
+					}
+				}
+			}
+		}
+		
+		tableMenu(const tableMenu &) = delete;
+		tableMenu & operator=(const tableMenu &) = delete;
+		
+		/// \brief
+		/// Gives the labels back to the pool
+		virtual ~tableMenu(){
+			for(unsigned int i = 0; i < n; i++){
+				menuLabelPool::get().release(labels[i]);
+			}
+		}
+		
+		/// \brief
+		/// returns the current value cursorPosition
+		unsigned int getCurrentCursorPos() override{
+			return cursorPosition;
+		}
+		
+		/// \brief
+		/// set cursorPosition to given value, if it is in the current menu
+		void setCursorPos(unsigned int i) override{
+			if(i < getCurrentMenuSize()){
+				cursorPosition = i;
+			}
+		}
+		
+		/// \brief
+		/// returns the number of entries in the current menu
+		unsigned int getCurrentMenuSize() override{
+			return currentMenu == n ? table.rootCount : table.childCount[currentMenu];
+		}
+		
+		/// \brief
+		/// returns the table index of the current menu, n for the top menu
+		unsigned int getCurrentMenuId() override{
+			return currentMenu;
+		}
+		
+		/// \brief
+		/// returns the label of an entry in the current menu, NULL past the last entry
+		const char * getCurrentLabel(unsigned int index){
+			if(index >= getCurrentMenuSize()){
+				return NULL;
+			}
+			return table.entries[firstEntry() + index].label;
+		}
+		
+		/// \brief
+		/// returns the rendered label of an entry in the current menu, NULL past the last entry
+		/// \details
+		/// The revision of a table label is always 0, that of a menuItem is the revision of the item.
+		const menuLabel * getLabel(const unsigned int & index, unsigned int & revision) override{
+			if(index >= getCurrentMenuSize()){
+				return NULL;
+			}
+			unsigned int entry = firstEntry() + index;
+			menuItem * item = getAction(entry);
+			revision = 0;
+			if(item != NULL){
+				revision = item->getRevision();
+				if(item->getLabel() != NULL){
+					return item->getLabel();
+				}
+				fallbackLabel.render(item->getName());
+				return &fallbackLabel;
+			}
+			if(labels[entry] != NULL){
+				return labels[entry];
+			}
+			fallbackLabel.render(table.entries[entry].label);
+			return &fallbackLabel;
+		}
+		
+		/// \brief
+		/// returns the table index of the current menu, n for the top menu
+		unsigned int getCurrentMenu(){
+			return currentMenu;
+		}
+		
+		/// \brief
+		/// Decreases the value of cursor position but not below 0.
+		void cursorUp() override{
+			if(cursorPosition > 0){
+				cursorPosition--;
+			}
+		}
+		
+		/// \brief
+		/// Increases the value of cursor position but not past the last entry.
+		void cursorDown() override{
+			if(cursorPosition + 1 < getCurrentMenuSize()){
+				cursorPosition++;
+			}
+		}
+		
+		/// \brief
+		/// Executes the selected entry.
+		/// \details
+		/// A submenu is opened with the cursor on its first entry, a back entry goes to the parent menu and any other entry runs its menuItem.
+		/// With a scheduler set the action of the menuItem is started on the scheduler.
+		void select() override{
+			if(cursorPosition >= getCurrentMenuSize()){
+				return;
+			}
+			unsigned int entry = firstEntry() + cursorPosition;
+			unsigned int action = table.entries[entry].action;
+			menuItem * item = getAction(entry);
+			if(action == MENU_SUBMENU){
+				currentMenu = entry;
+				cursorPosition = 0;
+			}else if(action == MENU_BACK){
+				previousMenu();
+			}else if(item != NULL && scheduler != NULL){
+				scheduler->start(item);
+			}else if(item != NULL){
+				item->run();
+			}
+		}
+		
+		/// \brief
+		/// Goes to the parent menu with the cursor on the menu that was left.
+		void previousMenu() override{
+			if(currentMenu == n){
+				return;
+			}
+			cursorPosition = table.position[currentMenu];
+			currentMenu = table.parent[currentMenu];
+		}
+		
+		/// \brief
+		/// Sets the scheduler that select() starts actions on, NULL runs them directly
+		void setScheduler(actionScheduler * newScheduler) override{
+			scheduler = newScheduler;
+		}
+};
+}
+#endif // MENUTABLE_HPP
@@ -0,0 +1,85 @@
+#ifndef MOTIONWAKE_HPP
+#define MOTIONWAKE_HPP
+#include "hwlib.hpp"
+#include "../../max7219.hpp"
+#include "MPU6050.hpp"
+
+/// \brief
+/// Puts the LED chain and the MPU6050 to sleep when idle, wakes on motion
+/// \details
+/// The powerManager fades the screens out and shuts them down after its idle
+/// timeout. Once they are shut down the MPU6050 goes into accelerometer-only
+/// cycle mode with the motion interrupt enabled. update() then only reads
+/// INT_STATUS every pollUs; on motion the sensor returns to normal mode and
+/// the screens fade back in. touch() reports other activity, like a button.
+template<unsigned int n>
+class motionWake{
+private:
+	MPU6050 & mpu;
+	max7219::powerManager<n> & power;
+	uint16_t thresholdMg;
+	mpuWakeRate rate;
+	uint_fast64_t pollUs;
+	uint_fast64_t lastPoll = 0;
+	bool sleeping = false;
+	
+	void wake(){
+		mpu.exitLowPower();
+		sleeping = false;
+		power.touch();
+	}
+	
+public:
+	motionWake(MPU6050 & mpu, max7219::powerManager<n> & power, const uint16_t & thresholdMg = 40, const mpuWakeRate & rate = mpuWakeRate::HZ_5, const uint_fast64_t & pollUs = 50000):
+		mpu(mpu),
+		power(power),
+		thresholdMg(thresholdMg),
+		rate(rate),
+		pollUs(pollUs)
+	{}
+	
+	/// \brief
+	/// Registers activity, wakes everything up if it was asleep
+	void touch(){
+		if(sleeping){
+			wake();
+		}else{
+			power.touch();
+		}
+	}
+	
+	/// \brief
+	/// Advances the fades and checks for motion, call every tick
+	/// \details
+	/// Returns true on the tick that motion woke the device.
+	bool update(){
+		power.update();
+		if(!sleeping){
+			if(power.isShutdown()){
+				mpu.enableMotionInterrupt(thresholdMg, 1);
+				mpu.enterLowPower(rate);
+				sleeping = true;
+				lastPoll = hwlib::now_us();
+			}
+			return false;
+		}
+		uint_fast64_t now = hwlib::now_us();
+		if(now - lastPoll < pollUs){
+			return false;
+		}
+		lastPoll = now;
+		if(mpu.getInterruptStatus() & MPU6050::INT_MOTION){
+			wake();
+			return true;
+		}
+		return false;
+	}
+	
+	/// \brief
+	/// Returns true while the screens and the sensor are in low power mode
+	bool isSleeping(){
+		return sleeping;
+	}
+};
+
+#endif // MOTIONWAKE_HPP
@@ -0,0 +1,159 @@
+#include "mpuCalibrator.hpp"
+
+void mpuCalibrator::values(const mpuSample & sample, int32_t value[6]){
+	value[0] = sample.accelX;
+	value[1] = sample.accelY;
+	value[2] = sample.accelZ;
+	value[3] = sample.gyroX;
+	value[4] = sample.gyroY;
+	value[5] = sample.gyroZ;
+}
+
+// Divides by 256 rounding to the nearest integer, halves away from zero, so
+// negative and positive values are treated alike. A right shift would round
+// towards minus infinity.
+int32_t mpuCalibrator::fromQ8(const int32_t & q8){
+	return q8 < 0 ? -((128 - q8) / 256) : (q8 + 128) / 256;
+}
+
+void mpuCalibrator::clear(){
+	count = 0;
+	for(unsigned int i = 0; i < 6; i++){
+		sum[i] = 0;
+		sumSquares[i] = 0;
+	}
+}
+
+void mpuCalibrator::start(){
+	clear();
+	rejected = 0;
+	current = state::COLLECTING;
+}
+
+void mpuCalibrator::stop(){
+	current = state::IDLE;
+}
+
+void mpuCalibrator::track(){
+	clear();
+	mpuCalibration offsets = mpu.getCalibration();
+	biasQ8[0] = int32_t(offsets.gyroX) * 256;
+	biasQ8[1] = int32_t(offsets.gyroY) * 256;
+	biasQ8[2] = int32_t(offsets.gyroZ) * 256;
+	current = state::TRACKING;
+}
+
+// The mean becomes the offset, except for the axis gravity is on: that one
+// keeps 1 g.
+void mpuCalibrator::finish(){
+	int16_t mean[6];
+	for(unsigned int i = 0; i < 6; i++){
+		mean[i] = sum[i] / int32_t(count);
+	}
+	unsigned int gravityAxis = 0;
+	for(unsigned int i = 1; i < 3; i++){
+		if(abs(mean[i]) > abs(mean[gravityAxis])){
+			gravityAxis = i;
+		}
+	}
+	int16_t oneG = 16384 >> mpu.getFullScaleAccelRange();
+	mean[gravityAxis] -= mean[gravityAxis] < 0 ? -oneG : oneG;
+	mpu.setCalibration(mpuCalibration{mean[0], mean[1], mean[2], mean[3], mean[4], mean[5]});
+	for(unsigned int i = 0; i < 3; i++){
+		biasQ8[i] = int32_t(mean[3 + i]) * 256;
+	}
+	current = state::TRACKING;
+}
+
+bool mpuCalibrator::feed(const mpuSample & sample){
+	int32_t value[6];
+	values(sample, value);
+	
+	if(current == state::COLLECTING){
+		if(count > 0){
+			for(unsigned int i = 0; i < 6; i++){
+				if(abs(value[i] - int32_t(sum[i] / int32_t(count))) > motionLimit){
+					++rejected;
+					clear();
+					return false;
+				}
+			}
+		}
+		++count;
+		for(unsigned int i = 0; i < 6; i++){
+			sum[i] += value[i];
+			sumSquares[i] += int64_t(value[i]) * value[i];
+		}
+		if(count < minSamples){
+			return false;
+		}
+		bool settled = true;
+		for(unsigned int i = 3; i < 6; i++){
+			// n * variance = sum of squares - sum * mean
+			int64_t variance = (sumSquares[i] - sum[i] * sum[i] / count) / count;
+			if(variance > int64_t(varianceLimit)){
+				settled = false;
+			}
+		}
+		if(settled){
+			finish();
+			return true;
+		}
+		if(count >= maxSamples){
+			clear();
+		}
+		return false;
+	}
+	
+	if(current == state::TRACKING){
+		// Only a still device shows the bias: every axis close to its offset
+		mpuCalibration offsets = mpu.getCalibration();
+		int32_t offset[3] = {offsets.gyroX, offsets.gyroY, offsets.gyroZ};
+		for(unsigned int i = 0; i < 3; i++){
+			if(abs(value[3 + i] - offset[i]) > motionLimit / 4){
+				return true;
+			}
+		}
+		for(unsigned int i = 0; i < 3; i++){
+			biasQ8[i] += fromQ8(value[3 + i] * 256 - biasQ8[i]);
+		}
+		offsets.gyroX = fromQ8(biasQ8[0]);
+		offsets.gyroY = fromQ8(biasQ8[1]);
+		offsets.gyroZ = fromQ8(biasQ8[2]);
+		mpu.setCalibration(offsets);
+		return true;
+	}
+	return false;
+}
+
+bool mpuCalibrator::step(){
+	if(current == state::IDLE){
+		return false;
+	}
+	uint_fast64_t now = hwlib::now_us();
+	if(now - lastStep < stepUs){
+		return current == state::TRACKING;
+	}
+	lastStep = now;
+	mpu.setAccelGyro();
+	mpuSample sample;
+	mpu.getSample(sample);
+	sample.timestamp = now;
+	return feed(sample);
+}
+
+mpuCalibrator::state mpuCalibrator::getState(){
+	return current;
+}
+
+bool mpuCalibrator::isCalibrated(){
+	return current == state::TRACKING;
+}
+
+uint32_t mpuCalibrator::getCount(){
+	return count;
+}
+
+uint32_t mpuCalibrator::getRejected(){
+	return rejected;
+}
@@ -0,0 +1,110 @@
+#ifndef MPUCALIBRATOR_HPP
+#define MPUCALIBRATOR_HPP
+#include "hwlib.hpp"
+#include "MPU6050.hpp"
+#include "mpuSample.hpp"
+
+/// \brief
+/// Calibrates the MPU6050 a sample at a time
+/// \details
+/// start() begins a calibration, after that every new sample is given to
+/// feed(), for example the samples mpuDataReady publishes. Without a data
+/// ready source, step() is called from the main loop instead: it reads at
+/// most one sample per stepUs itself. Either way the display and menu keep
+/// running. Samples that differ too much from the running mean are seen as
+/// motion and start the collection over. Once at least minSamples still
+/// samples are collected and the gyro variance of every axis is below
+/// varianceLimit, the offsets are written to the MPU6050.
+///
+/// After that the calibrator keeps tracking the gyro bias in the background:
+/// samples where the device is still slowly pull the gyro offsets towards the
+/// measured rate.
+class mpuCalibrator{
+public:
+	enum class state { IDLE, COLLECTING, TRACKING };
+	
+private:
+	MPU6050 & mpu;
+	state current = state::IDLE;
+	uint_fast64_t lastStep = 0;
+	uint32_t stepUs;
+	
+	//Running statistics in raw units: accel x, y, z, gyro x, y, z
+	uint32_t count = 0;
+	int64_t sum[6] = {};
+	int64_t sumSquares[6] = {};
+	uint32_t rejected = 0;
+	
+	//Gyro offsets in Q8 for the background tracking
+	int32_t biasQ8[3] = {};
+	
+	int16_t motionLimit;
+	uint32_t varianceLimit;
+	uint32_t minSamples;
+	uint32_t maxSamples;
+	
+	static void values(const mpuSample & sample, int32_t value[6]);
+	static int32_t fromQ8(const int32_t & q8);
+	void clear();
+	void finish();
+	
+public:
+	/// \brief
+	/// Constructs the calibrator
+	/// \details
+	/// motionLimit is the largest difference from the running mean, in raw
+	/// units, a still sample may have. varianceLimit is the gyro variance
+	/// (raw units squared) needed to finish. A collection that does not settle
+	/// within maxSamples starts over.
+	mpuCalibrator(MPU6050 & mpu, const uint32_t & stepUs = 2000, const int16_t & motionLimit = 300, const uint32_t & varianceLimit = 64, const uint32_t & minSamples = 64, const uint32_t & maxSamples = 512):
+		mpu(mpu),
+		stepUs(stepUs),
+		motionLimit(motionLimit),
+		varianceLimit(varianceLimit),
+		minSamples(minSamples),
+		maxSamples(maxSamples)
+	{}
+	
+	/// \brief
+	/// Starts a new calibration, keep the device still
+	void start();
+	
+	/// \brief
+	/// Starts tracking the gyro bias from the calibration set on the MPU6050
+	/// \details
+	/// For a calibration that was stored earlier, no collection is needed.
+	void track();
+	
+	/// \brief
+	/// Stops calibrating and tracking
+	void stop();
+	
+	/// \brief
+	/// Reads and processes one sample if stepUs passed since the previous one
+	/// \details
+	/// Returns true once the calibration is complete. Only for use without
+	/// a data ready source, otherwise feed() the samples it reads.
+	bool step();
+	
+	/// \brief
+	/// Processes a sample read elsewhere, for example by mpuDataReady
+	/// \details
+	/// Returns true once the calibration is complete.
+	bool feed(const mpuSample & sample);
+	
+	state getState();
+	
+	/// \brief
+	/// Returns true when the offsets are set and the bias is being tracked
+	bool isCalibrated();
+	
+	/// \brief
+	/// Returns the number of still samples collected so far
+	uint32_t getCount();
+	
+	/// \brief
+	/// Returns the number of samples rejected as motion
+	uint32_t getRejected();
+};
+
+#endif // MPUCALIBRATOR_HPP
@@ -0,0 +1,65 @@
+#ifndef MPUCONFIG_HPP
+#define MPUCONFIG_HPP
+#include "hwlib.hpp"
+
+// Digital low pass filter bandwidth (accelerometer), CONFIG register.
+// Everything but BW_260HZ lowers the gyro output rate from 8 kHz to 1 kHz.
+enum class mpuDlpf : uint8_t {
+	BW_260HZ = 0,
+	BW_184HZ = 1,
+	BW_94HZ = 2,
+	BW_44HZ = 3,
+	BW_21HZ = 4,
+	BW_10HZ = 5,
+	BW_5HZ = 6
+};
+
+// Clock source, PWR_MGMT_1 register
+enum class mpuClock : uint8_t {
+	INTERNAL = 0,
+	PLL_XGYRO = 1,
+	PLL_YGYRO = 2,
+	PLL_ZGYRO = 3,
+	PLL_EXT32K = 4,
+	PLL_EXT19M = 5,
+	KEEP_RESET = 7
+};
+
+// Gyroscope full scale range, GYRO_CONFIG register
+enum class mpuGyroRange : uint8_t {
+	DPS_250 = 0,
+	DPS_500 = 1,
+	DPS_1000 = 2,
+	DPS_2000 = 3
+};
+
+// Accelerometer full scale range, ACCEL_CONFIG register
+enum class mpuAccelRange : uint8_t {
+	G_2 = 0,
+	G_4 = 1,
+	G_8 = 2,
+	G_16 = 3
+};
+
+// Accelerometer sample rate in low power cycle mode, PWR_MGMT_2 register
+enum class mpuWakeRate : uint8_t {
+	HZ_1_25 = 0,
+	HZ_5 = 1,
+	HZ_20 = 2,
+	HZ_40 = 3
+};
+
+/// \brief
+/// MPU6050 sensor configuration
+/// \details
+/// The defaults are the power-on values of the MPU6050. The sample rate is
+/// the gyro output rate / (1 + sampleRateDivider).
+struct mpuConfig{
+	mpuClock clock = mpuClock::INTERNAL;
+	mpuDlpf dlpf = mpuDlpf::BW_260HZ;
+	uint8_t sampleRateDivider = 0;
+	mpuGyroRange gyroRange = mpuGyroRange::DPS_250;
+	mpuAccelRange accelRange = mpuAccelRange::G_2;
+};
+
+#endif // MPUCONFIG_HPP
@@ -0,0 +1,117 @@
+#ifndef MPUDATAREADY_HPP
+#define MPUDATAREADY_HPP
+#include "hwlib.hpp"
+#include "MPU6050.hpp"
+#include "mpuSample.hpp"
+#include "orientation.hpp"
+
+/// \brief
+/// Reads the MPU6050 only when its interrupt says there is new data
+/// \details
+/// The MPU6050 INT pin is connected to intPin. onInterrupt() is meant to be
+/// called from the pin change interrupt handler of that pin and only sets a
+/// flag. Without an interrupt handler, update() looks at the pin itself.
+///
+/// update() does the I2C work: when data is ready it reads one burst, or
+/// drains the FIFO when FIFO mode is enabled, and publishes the newest sample.
+/// The application gets it lock-free through getLatest().
+///
+/// With setFilter() every sample read, including every sample drained from
+/// the FIFO, is scaled and fed to an orientationFilter.
+class mpuDataReady{
+private:
+	MPU6050 & mpu;
+	hwlib::pin_in & intPin;
+	volatile bool pending = false;
+	bool fifoMode;
+	sampleSnapshot latest;
+	orientationFilter * filter = nullptr;
+	
+	void feed(const mpuSample & sample){
+		if(filter != nullptr){
+			mpuScaledSample scaled;
+			mpu.scale(sample, scaled);
+			filter->update(scaled);
+		}
+	}
+public:
+	mpuDataReady(MPU6050 & mpu, hwlib::pin_in & intPin, const bool & fifoMode = false):
+		mpu(mpu),
+		intPin(intPin),
+		fifoMode(fifoMode)
+	{}
+	
+	/// \brief
+	/// Enables the data ready (or FIFO overflow) interrupt on the MPU6050
+	void begin(){
+		mpu.enableInterrupt(fifoMode ? MPU6050::INT_FIFO_OVERFLOW | MPU6050::INT_DATA_READY : MPU6050::INT_DATA_READY);
+		mpu.getInterruptStatus();
+	}
+	
+	/// \brief
+	/// Marks new data as ready, safe to call from an interrupt handler
+	void onInterrupt(){
+		pending = true;
+	}
+	
+	/// \brief
+	/// Reads the sensor if new data is ready
+	/// \details
+	/// Returns true if a new sample was published. Reading INT_STATUS 
+	/// releases the INT pin for the next sample. It is read once and also
+	/// handed to drainFifo(), because the read clears the FIFO overflow flag.
+	bool update(){
+		if(!pending && !intPin.get()){
+			return false;
+		}
+		pending = false;
+		byte status = mpu.getInterruptStatus();
+		mpuSample sample;
+		if(fifoMode){
+			if(mpu.drainFifo(status) == 0){
+				return false;
+			}
+			bool any = false;
+			while(mpu.getFifoSamples().pop(sample)){
+				feed(sample);
+				any = true;
+			}
+			if(!any){
+				return false;
+			}
+		}else{
+			if(!(status & MPU6050::INT_DATA_READY)){
+				return false;
+			}
+			mpu.setAccelGyro();
+			mpu.getSample(sample);
+			sample.timestamp = hwlib::now_us();
+			feed(sample);
+		}
+		latest.publish(sample);
+		return true;
+	}
+	
+	/// \brief
+	/// Sets the filter fed with every sample, nullptr to stop feeding
+	void setFilter(orientationFilter * newFilter){
+		filter = newFilter;
+	}
+	
+	/// \brief
+	/// Returns the newest pitch and roll of the filter
+	orientation getOrientation(){
+		return filter != nullptr ? filter->get() : orientation{0, 0, 0};
+	}
+	
+	/// \brief
+	/// Copies the newest sample, returns its sequence number
+	/// \details
+	/// Sequence 0 means no sample was read yet. A sequence number that
+	/// did not change since the previous call means the sample is not new.
+	uint32_t getLatest(mpuSample & sample){
+		return latest.read(sample);
+	}
+};
+
+#endif // MPUDATAREADY_HPP
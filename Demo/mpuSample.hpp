@@ -0,0 +1,125 @@
+#ifndef MPUSAMPLE_HPP
+#define MPUSAMPLE_HPP
+#include "hwlib.hpp"
+#include <atomic>
+
+/// \brief
+/// One raw MPU6050 sample with the time it was taken
+/// \details
+/// Sensors that were not sampled are left 0. The timestamp is in hwlib::now_us()
+/// microseconds.
+struct mpuSample{
+	uint_fast64_t timestamp;
+	int16_t accelX, accelY, accelZ;
+	int16_t temperature;
+	int16_t gyroX, gyroY, gyroZ;
+};
+
+/// \brief
+/// MPU6050 sample converted to fixed-point units
+/// \details
+/// Acceleration in milli-g, rotation in milli-degrees per second and 
+/// temperature in milli-degrees Celsius, with calibration offsets applied.
+struct mpuScaledSample{
+	uint_fast64_t timestamp;
+	int32_t accelX, accelY, accelZ;
+	int32_t temperature;
+	int32_t gyroX, gyroY, gyroZ;
+};
+
+/// \brief
+/// Raw offsets subtracted from every MPU6050 sample
+/// \details
+/// Plain data, so it can be stored and loaded again with setCalibration()
+/// instead of calibrating on every boot.
+struct mpuCalibration{
+	int16_t accelX, accelY, accelZ;
+	int16_t gyroX, gyroY, gyroZ;
+};
+
+/// \brief
+/// Fixed size ring buffer of samples
+/// \details
+/// When the buffer is full the oldest sample is overwritten, the number of
+/// overwritten samples is kept in getDropped().
+template<unsigned int n>
+class sampleRingBuffer{
+private:
+	mpuSample samples[n];
+	unsigned int head = 0;
+	unsigned int count = 0;
+	unsigned int dropped = 0;
+public:
+	void push(const mpuSample & sample){
+		samples[(head + count) % n] = sample;
+		if(count < n){
+			++count;
+		}else{
+			head = (head + 1) % n;
+			++dropped;
+		}
+	}
+	
+	bool pop(mpuSample & sample){
+		if(count == 0){
+			return false;
+		}
+		sample = samples[head];
+		head = (head + 1) % n;
+		--count;
+		return true;
+	}
+	
+	unsigned int size(){
+		return count;
+	}
+	
+	unsigned int getDropped(){
+		return dropped;
+	}
+	
+	void clear(){
+		head = 0;
+		count = 0;
+	}
+};
+
+/// \brief
+/// Latest sample, published lock-free through a sequence counter
+/// \details
+/// The writer makes the sequence odd while it copies the sample and even
+/// again when done. A reader copies the sample and retries if the sequence
+/// was odd or changed meanwhile, so it never sees half a sample, even when
+/// the writer is an interrupt handler. There is only one writer.
+class sampleSnapshot{
+private:
+	volatile uint32_t sequence = 0;
+	mpuSample sample = {};
+public:
+	void publish(const mpuSample & newSample){
+		sequence = sequence + 1;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+		sample = newSample;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+		sequence = sequence + 1;
+	}
+	
+	/// \brief
+	/// Copies the latest sample, returns its sequence number
+	/// \details
+	/// Sequence 0 means nothing was published yet. Comparing sequence numbers
+	/// tells if a sample is new.
+	uint32_t read(mpuSample & copy){
+		uint32_t before, after;
+		do{
+			before = sequence;
+			std::atomic_signal_fence(std::memory_order_seq_cst);
+			copy = sample;
+			std::atomic_signal_fence(std::memory_order_seq_cst);
+			after = sequence;
+		}while((before & 1) || before != after);
+		return before / 2;
+	}
+};
+
+#endif // MPUSAMPLE_HPP
@@ -0,0 +1,61 @@
+#ifndef NAVIGABLEMENU_HPP
+#define NAVIGABLEMENU_HPP
+
+#include "menuLabel.hpp"
+#include "actionScheduler.hpp"
+
+namespace lightMenu{
+	/// @file
+
+	/// \brief
+	/// The navigation that displays and controllers use.
+	/// \details
+	/// baseMenu and tableMenu both implement this, so a displayMenu or controlMenu works with either of them.
+	/// A menu is known by its id, the entries of the current menu by their index from 0 to getCurrentMenuSize() - 1.
+class navigableMenu{
+public:
+	/// \brief
+	/// returns the current value of the cursor position
+	virtual unsigned int getCurrentCursorPos() = 0;
+	
+	/// \brief
+	/// set the cursor position to given value, if it is in the current menu
+	virtual void setCursorPos(unsigned int i) = 0;
+	
+	/// \brief
+	/// returns the number of entries in the current menu
+	virtual unsigned int getCurrentMenuSize() = 0;
+	
+	/// \brief
+	/// returns a number that is different for every menu
+	virtual unsigned int getCurrentMenuId() = 0;
+	
+	/// \brief
+	/// returns the rendered label of an entry of the current menu
+	/// \details
+	/// Returns NULL past the last entry. revision is set to a number that changes when the label changes.
+	/// The label may be overwritten by the next call, a display that keeps it has to copy it.
+	virtual const menuLabel * getLabel(const unsigned int & index, unsigned int & revision) = 0;
+	
+	/// \brief
+	/// moves the cursor up, not above the first entry
+	virtual void cursorUp() = 0;
+	
+	/// \brief
+	/// moves the cursor down, not past the last entry
+	virtual void cursorDown() = 0;
+	
+	/// \brief
+	/// executes the selected entry
+	virtual void select() = 0;
+	
+	/// \brief
+	/// goes to the parent menu of the current menu
+	virtual void previousMenu() = 0;
+	
+	/// \brief
+	/// sets the scheduler that select() starts actions on, NULL runs them directly
+	virtual void setScheduler(actionScheduler * newScheduler) = 0;
+};
+}
+#endif // NAVIGABLEMENU_HPP
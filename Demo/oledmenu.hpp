@@ -16,40 +16,149 @@
 #define OLEDMENU_HPP
 #include "hwlib.hpp"
 #include "lightMenu.hpp"
-template<int t, int u>
-class oledMenu : public lightMenu::displayMenu<t, u>
+/// \brief
+/// Draws the menu on an SSD1306 OLED, one 8 pixel page per line
+/// \details
+/// Every menu line is one page of the OLED: the cursor marker followed by
+/// the label of the entry, which the menu rendered when its name was set.
+/// For each page the entry, its label, the revision of that label and the
+/// cursor marker that were drawn are remembered. draw() only sends the pages where one of
+/// those changed, straight to the OLED over its i2c bus, so a small change
+/// costs a page write instead of the whole 1 KB framebuffer and no font
+/// rendering.
+///
+/// The lines show a window of the current menu that only scrolls when the
+/// cursor would leave it, the cursor marker moves within the window. Moving
+/// the cursor repaints two pages, a scroll repaints the window.
+///
+/// Something else that draws on the OLED, like the game, leaves the
+/// remembered pages wrong; invalidate() makes the next draw() repaint all
+/// pages.
+class oledMenu : public lightMenu::displayMenu
 {
+	static const unsigned int PAGES = 8;
+	static const unsigned int WIDTH = 128;
+	static const unsigned int MARKER_WIDTH = 8;
+	
+	/// \brief
+	/// What was drawn on a page
+	struct pageState{
+		unsigned int menu;
+		unsigned int index;
+		const lightMenu::menuLabel * label;
+		unsigned int revision;
+		bool cursor;
+		bool valid;
+	};
 	
 	hwlib::glcd_oled & display;
-	int lines;
+	hwlib::i2c_bus & bus;
+	uint8_t address;
+	unsigned int lines;
+	uint8_t marker[MARKER_WIDTH];
+	pageState drawn[PAGES];
+	unsigned int firstVisible = 0;
+	unsigned int shownMenu = 0;
+	
+	/// \brief
+	/// Scrolls the window just far enough to keep the cursor in it
+	/// \details
+	/// A different menu starts at the top again.
+	void scrollToCursor(){
+		unsigned int cursor = menuRef.getCurrentCursorPos();
+		unsigned int menuIndex = menuRef.getCurrentMenuId();
+		if(menuIndex != shownMenu){
+			shownMenu = menuIndex;
+			firstVisible = 0;
+		}
+		if(lines == 0){
+			return;
+		}
+		if(cursor < firstVisible){
+			firstVisible = cursor;
+		}else if(cursor >= firstVisible + lines){
+			firstVisible = cursor + 1 - lines;
+		}
+	}
+	
+	/// \brief
+	/// Finds out what a page should show: entry, label, revision and cursor
+	/// marker
+	pageState composePage(const unsigned int & page){
+		pageState state = {menuRef.getCurrentMenuId(), 0, NULL, 0, false, true};
+		if(page >= lines){
+			return state;
+		}
+		state.index = firstVisible + page;
+		state.cursor = state.index == menuRef.getCurrentCursorPos();
+		state.label = menuRef.getLabel(state.index, state.revision);
+		return state;
+	}
+	
+	/// \brief
+	/// Sends a page: the cursor marker and the label of the entry
+	/// \details
+	/// The column and page address are set in one command transfer, the 128
+	/// columns of the page follow in one data transfer.
+	void writePage(const unsigned int & page, const pageState & state){
+		uint8_t commands[] = {0x00, 0x21, 0, WIDTH - 1, 0x22, uint8_t(page), uint8_t(page)};
+		bus.write(address, commands, sizeof(commands));
+		uint8_t data[WIDTH + 1] = {};
+		data[0] = 0x40;
+		if(state.cursor){
+			for(unsigned int x = 0; x < MARKER_WIDTH; x++){
+				data[1 + x] = marker[x];
+			}
+		}
+		if(state.label != NULL){
+			for(unsigned int x = 0; x < state.label->width && MARKER_WIDTH + x < WIDTH; x++){
+				data[1 + MARKER_WIDTH + x] = state.label->columns[x];
+			}
+		}
+		bus.write(address, data, sizeof(data));
+	}
+	
 public:
-	oledMenu(lightMenu::baseMenu<t, u> & baseMenu, hwlib::glcd_oled & display, int lines):
-	lightMenu::displayMenu<t, u>(baseMenu),
+	oledMenu(lightMenu::navigableMenu & menu, hwlib::glcd_oled & display, hwlib::i2c_bus & bus, const uint8_t & address, int lines):
+	lightMenu::displayMenu(menu),
 	display(display),
-	lines(lines)
-	{}
-
+	bus(bus),
+	address(address),
+	lines(lines > int(PAGES) ? PAGES : lines)
+	{
+		lightMenu::menuLabel rendered;
+		rendered.renderCharacter(hwlib::font_default_8x8(), 0, char(62));
+		for(unsigned int x = 0; x < MARKER_WIDTH; x++){
+			marker[x] = rendered.columns[x];
+		}
+		invalidate();
+	}
+	
+	/// \brief
+	/// Draws the pages that changed since the last draw
 	void draw() override{
-		auto font    = hwlib::font_default_8x8();
-		auto writeableDisplay = hwlib::window_ostream(display, font );
-		writeableDisplay << '\f';
-		for(unsigned int i = lightMenu::displayMenu<t,u>::baseMenuRef.getCurrentCursorPos(); i < lines + lightMenu::displayMenu<t,u>::baseMenuRef.getCurrentCursorPos(); i++){
-			
-			if( i == lightMenu::displayMenu<t,u>::baseMenuRef.getCurrentCursorPos()){
-				writeableDisplay << char(62);
-			}else{
-				writeableDisplay << " ";
-			}
-			if(i < lightMenu::displayMenu<t,u>::baseMenuRef.getCurrentMenuSize()){
-				writeableDisplay << lightMenu::displayMenu<t,u>::baseMenuRef.getCurrentMenu()->getMenuItemByIndex(i)->getName();
+		scrollToCursor();
+		for(unsigned int page = 0; page < PAGES; page++){
+			pageState state = composePage(page);
+			const pageState & old = drawn[page];
+			if(!old.valid || old.menu != state.menu || old.index != state.index || old.label != state.label || old.revision != state.revision || old.cursor != state.cursor){
+				writePage(page, state);
+				drawn[page] = state;
 			}
-			writeableDisplay << '\n';
 		}
-		writeableDisplay << hwlib::flush;
+	}
+	
+	/// \brief
+	/// Makes the next draw() repaint every page
+	void invalidate() override{
+		for(unsigned int page = 0; page < PAGES; page++){
+			drawn[page].valid = false;
+		}
 	}
 	
 	void clear() override{
 		display.clear();
+		invalidate();
 	}
 
 };
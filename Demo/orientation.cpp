@@ -0,0 +1,93 @@
+#include "orientation.hpp"
+
+// atan of a ratio between 0 and 1 (Q15) in milli-degrees, using
+// atan(x) = 45x + x(1 - x)(14.02 + 3.80x) degrees.
+int32_t orientationFilter::atanUnit(const int32_t & ratioQ15){
+	int32_t term = 14021 + ((3799 * ratioQ15) >> 15);
+	int32_t curve = (ratioQ15 * (32768 - ratioQ15)) >> 15;
+	return ((45000 * ratioQ15) >> 15) + ((curve * term) >> 15);
+}
+
+int32_t orientationFilter::wrap(const int32_t & angle){
+	if(angle > 180000){
+		return angle - 360000;
+	}
+	if(angle < -180000){
+		return angle + 360000;
+	}
+	return angle;
+}
+
+int32_t orientationFilter::atan2(const int32_t & y, const int32_t & x){
+	if(x == 0 && y == 0){
+		return 0;
+	}
+	int64_t absY = y < 0 ? -int64_t(y) : y;
+	int64_t absX = x < 0 ? -int64_t(x) : x;
+	int32_t angle;
+	if(absY <= absX){
+		angle = atanUnit(int32_t((absY << 15) / absX));
+	}else{
+		angle = 90000 - atanUnit(int32_t((absX << 15) / absY));
+	}
+	if(x < 0){
+		angle = 180000 - angle;
+	}
+	return y < 0 ? -angle : angle;
+}
+
+uint32_t orientationFilter::sqrt(const uint32_t & value){
+	uint32_t remainder = value;
+	uint32_t root = 0;
+	uint32_t bit = uint32_t(1) << 30;
+	for(int i = 0; i < 16; i++){
+		if(remainder >= root + bit){
+			remainder -= root + bit;
+			root = (root >> 1) + bit;
+		}else{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return root;
+}
+
+void orientationFilter::update(const mpuScaledSample & sample){
+	uint32_t lengthYZ = sqrt(uint32_t(sample.accelY * sample.accelY) + uint32_t(sample.accelZ * sample.accelZ));
+	int32_t accelPitch = atan2(-sample.accelX, lengthYZ);
+	int32_t accelRoll = atan2(sample.accelY, sample.accelZ);
+	
+	uint_fast64_t stepUs = sample.timestamp - current.timestamp;
+	if(!started || stepUs > maxStepUs){
+		current = orientation{sample.timestamp, accelPitch, accelRoll};
+		started = true;
+		return;
+	}
+	
+	// milli-degrees/s * us / 1000000, as a multiply by 2^32 / 1000000
+	int32_t rollStep = (int64_t(sample.gyroX) * int64_t(stepUs) * 4295) >> 32;
+	int32_t pitchStep = (int64_t(sample.gyroY) * int64_t(stepUs) * 4295) >> 32;
+	int32_t roll = wrap(current.roll + rollStep);
+	int32_t pitch = current.pitch + pitchStep;
+	
+	roll += (wrap(accelRoll - roll) * accelWeight) >> 8;
+	pitch += ((accelPitch - pitch) * accelWeight) >> 8;
+	
+	current = orientation{sample.timestamp, pitch, wrap(roll)};
+}
+
+void orientationFilter::reset(){
+	started = false;
+}
+
+orientation orientationFilter::get(){
+	return current;
+}
+
+int32_t orientationFilter::getPitch(){
+	return current.pitch;
+}
+
+int32_t orientationFilter::getRoll(){
+	return current.roll;
+}
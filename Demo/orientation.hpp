@@ -0,0 +1,79 @@
+#ifndef ORIENTATION_HPP
+#define ORIENTATION_HPP
+#include "hwlib.hpp"
+#include "mpuSample.hpp"
+
+/// \brief
+/// Pitch and roll at one moment, in milli-degrees
+struct orientation{
+	uint_fast64_t timestamp;
+	int32_t pitch;
+	int32_t roll;
+};
+
+/// \brief
+/// Fixed-point complementary filter for pitch and roll
+/// \details
+/// Fuses the gyro (fast, but drifting) with the accelerometer (noisy, but
+/// without drift). Every update integrates the gyro rate over the time since
+/// the previous sample and then moves the result a fraction towards the angle
+/// of the gravity vector.
+///
+/// Only integer math is used: a polynomial atan2, a 16 step integer square
+/// root and 32x32->64 bit multiplies, so an update takes a fixed, small number
+/// of cycles on the Cortex-M3 without FPU. There are no loops that depend on
+/// the input.
+class orientationFilter{
+private:
+	orientation current = {0, 0, 0};
+	bool started = false;
+	//Weight of the accelerometer correction in 1/256 units
+	int32_t accelWeight;
+	//Samples further apart than this are treated as a restart
+	uint32_t maxStepUs;
+	
+	static int32_t atanUnit(const int32_t & ratioQ15);
+	static int32_t wrap(const int32_t & angle);
+	
+public:
+	/// \brief
+	/// Constructs the filter
+	/// \details
+	/// accelWeight is the part of the accelerometer angle mixed in on every
+	/// update, in 1/256 units. The default of 5 (about 2%) suits a 100 Hz - 1 kHz
+	/// sample rate.
+	orientationFilter(const int32_t & accelWeight = 5, const uint32_t & maxStepUs = 100000):
+		accelWeight(accelWeight),
+		maxStepUs(maxStepUs)
+	{}
+	
+	/// \brief
+	/// Returns atan2(y, x) in milli-degrees, in the range -180000 - 180000
+	/// \details
+	/// Maximum error is about 0.1 degree.
+	static int32_t atan2(const int32_t & y, const int32_t & x);
+	
+	/// \brief
+	/// Returns the integer square root of value
+	static uint32_t sqrt(const uint32_t & value);
+	
+	/// \brief
+	/// Feeds one scaled sample to the filter
+	/// \details
+	/// The first sample, and any sample after a gap longer than maxStepUs,
+	/// sets the angles from the accelerometer only.
+	void update(const mpuScaledSample & sample);
+	
+	/// \brief
+	/// Starts over with the next sample
+	void reset();
+	
+	/// \brief
+	/// Returns the latest pitch and roll
+	orientation get();
+	
+	int32_t getPitch();
+	int32_t getRoll();
+};
+
+#endif // ORIENTATION_HPP
@@ -0,0 +1,142 @@
+#ifndef RUNLOOP_HPP
+#define RUNLOOP_HPP
+#include <array>
+#include "hwlib.hpp"
+#include "lightMenu.hpp"
+#include "menuController.hpp"
+#include "tracer.hpp"
+
+/// \brief
+/// Work that has to be done every tick of the runLoop
+/// \details
+/// active is true when a button was used or a menu action is running in
+/// this tick, for things like an idle timeout.
+class tickTask{
+public:
+	virtual void tick(const bool & active) = 0;
+};
+
+/// \brief
+/// Main loop of a menu with cooperative actions
+/// \details
+/// Every tick reads the buttons, advances the running menu action one step
+/// and then ticks the tasks. Without a running action button presses move
+/// the cursor or start the action of the selected item, and the displays are
+/// redrawn after a change. While an action runs the displays are left alone
+/// and holding select cancels it. When the action ends, the displays are
+/// invalidated and repainted, because the action may have drawn on them.
+///
+/// Up to n displays and n tasks can be added. With a tracer the redraw after
+/// input is timed, and so is the time from the button event to the end of
+/// the redraw.
+template<unsigned int n = 4>
+class runLoop
+{
+	menuController & control;
+	lightMenu::actionScheduler & scheduler;
+	std::array<lightMenu::displayMenu*, n> displays = {};
+	std::array<tickTask*, n> tasks = {};
+	unsigned int displayCount = 0;
+	unsigned int taskCount = 0;
+	tracer * trace = NULL;
+	int spanDraw = -1;
+	int spanButton = -1;
+	
+	/// \brief
+	/// Draws all displays, after invalidating them if repaint is set
+	void drawAll(const bool & repaint){
+		for(unsigned int i = 0; i < displayCount; i++){
+			if(repaint){
+				displays[i]->invalidate();
+			}
+			displays[i]->draw();
+		}
+	}
+	
+public:
+	/// \brief
+	/// Constructs the loop and sets the scheduler on the menu
+	runLoop(lightMenu::navigableMenu & menu, menuController & control, lightMenu::actionScheduler & scheduler):
+		control(control),
+		scheduler(scheduler)
+	{
+		menu.setScheduler(&scheduler);
+	}
+	
+	/// \brief
+	/// Adds a display, returns false when all n places are used
+	bool addDisplay(lightMenu::displayMenu * display){
+		if(displayCount >= n){
+			return false;
+		}
+		displays[displayCount++] = display;
+		return true;
+	}
+	
+	/// \brief
+	/// Adds a task, returns false when all n places are used
+	bool addTask(tickTask * task){
+		if(taskCount >= n){
+			return false;
+		}
+		tasks[taskCount++] = task;
+		return true;
+	}
+	
+	/// \brief
+	/// Times the redraws with the given tracer, NULL stops timing
+	void setTracer(tracer * newTrace){
+		trace = newTrace;
+		if(trace != NULL){
+			spanDraw = trace->addSpan("menu draw");
+			spanButton = trace->addSpan("button to draw");
+		}
+	}
+	
+	/// \brief
+	/// Does one pass of the loop, never waits
+	void tick(){
+		bool active = false;
+		if(scheduler.isBusy()){
+			active = true;
+			if(control.readCancel()){
+				scheduler.cancel();
+			}else{
+				scheduler.tick();
+			}
+			if(!scheduler.isBusy()){
+				drawAll(true);
+			}
+		}else if(control.read()){
+			active = true;
+			if(!scheduler.isBusy()){
+				uint32_t start = tracer::now();
+				drawAll(false);
+				if(trace != NULL){
+					trace->end(spanDraw, start);
+					trace->record(spanButton, (hwlib::now_us() - control.getLastEventUs()) * tracer::getTicksPerUs());
+				}
+			}
+		}
+		for(unsigned int i = 0; i < taskCount; i++){
+			tasks[i]->tick(active);
+		}
+	}
+	
+	/// \brief
+	/// Draws the menu and runs the loop forever
+	void run(){
+		drawAll(true);
+		for(;;){
+			tick();
+		}
+	}
+	
+	/// \brief
+	/// Returns whether a menu action is running
+	bool isBusy() const{
+		return scheduler.isBusy();
+	}
+};
+
+#endif // RUNLOOP_HPP
@@ -0,0 +1,59 @@
+#include "sam3xFlashPages.hpp"
+
+sam3xFlashPages::sam3xFlashPages(const unsigned int & count):
+	firstPage(IFLASH1_NB_OF_PAGES - (count > IFLASH1_NB_OF_PAGES ? IFLASH1_NB_OF_PAGES : count)),
+	count(count > IFLASH1_NB_OF_PAGES ? IFLASH1_NB_OF_PAGES : count)
+{
+	// Programming needs 6 wait states, only bank 1 is slowed down by this
+	EFC1->EEFC_FMR = (EFC1->EEFC_FMR & ~EEFC_FMR_FWS_Msk) | EEFC_FMR_FWS(6);
+}
+
+uint8_t * sam3xFlashPages::address(const unsigned int & page){
+	return reinterpret_cast<uint8_t *>(IFLASH1_ADDR + (firstPage + page) * IFLASH1_PAGE_SIZE);
+}
+
+// The page is copied to the latch buffer with 32 bit writes anywhere in the
+// page, the command then programs the latch buffer into the page.
+bool sam3xFlashPages::command(const unsigned int & page, const uint8_t data[PAGE_SIZE], const uint32_t & flashCommand){
+	if(page >= count){
+		++errors;
+		return false;
+	}
+	volatile uint32_t * latch = reinterpret_cast<volatile uint32_t *>(address(page));
+	for(unsigned int i = 0; i < PAGE_SIZE / 4; i++){
+		latch[i] = uint32_t(data[i * 4]) | uint32_t(data[i * 4 + 1]) << 8 | uint32_t(data[i * 4 + 2]) << 16 | uint32_t(data[i * 4 + 3]) << 24;
+	}
+	EFC1->EEFC_FCR = EEFC_FCR_FKEY(FLASH_KEY) | EEFC_FCR_FARG(firstPage + page) | EEFC_FCR_FCMD(flashCommand);
+	uint32_t status;
+	do{
+		status = EFC1->EEFC_FSR;
+	}while(!(status & EEFC_FSR_FRDY));
+	if(status & (EEFC_FSR_FCMDE | EEFC_FSR_FLOCKE)){
+		++errors;
+		return false;
+	}
+	return true;
+}
+
+unsigned int sam3xFlashPages::getPageCount() const{
+	return count;
+}
+
+void sam3xFlashPages::read(const unsigned int & page, uint8_t data[PAGE_SIZE]){
+	const uint8_t * source = address(page);
+	for(unsigned int i = 0; i < PAGE_SIZE; i++){
+		data[i] = page < count ? source[i] : 0xFF;
+	}
+}
+
+bool sam3xFlashPages::program(const unsigned int & page, const uint8_t data[PAGE_SIZE]){
+	return command(page, data, COMMAND_WP);
+}
+
+bool sam3xFlashPages::eraseAndProgram(const unsigned int & page, const uint8_t data[PAGE_SIZE]){
+	return command(page, data, COMMAND_EWP);
+}
+
+unsigned int sam3xFlashPages::getErrors(){
+	return errors;
+}
@@ -0,0 +1,44 @@
+#ifndef SAM3XFLASHPAGES_HPP
+#define SAM3XFLASHPAGES_HPP
+#include "hwlib.hpp"
+#include "flashPages.hpp"
+
+/// \brief
+/// The last pages of the second flash bank of the SAM3X8E
+/// \details
+/// The pages are written by the EEFC1 controller with the Write Page and
+/// Erase and Write Page commands. While bank 1 is being programmed the code
+/// keeps running from bank 0, so the program must stay below 256 KB. A
+/// command on a locked page, or a command error, fails the write and is
+/// counted in getErrors().
+///
+/// Uploading a new program with bossac erases the whole flash, so the
+/// pages are empty again after every upload.
+class sam3xFlashPages : public flashPages{
+	static const uint32_t FLASH_KEY = 0x5A;
+	static const uint32_t COMMAND_WP = 0x01;
+	static const uint32_t COMMAND_EWP = 0x03;
+	
+	unsigned int firstPage;
+	unsigned int count;
+	unsigned int errors = 0;
+	
+	uint8_t * address(const unsigned int & page);
+	bool command(const unsigned int & page, const uint8_t data[PAGE_SIZE], const uint32_t & flashCommand);
+	
+public:
+	/// \brief
+	/// Uses the last count pages of bank 1
+	sam3xFlashPages(const unsigned int & count = 8);
+	
+	unsigned int getPageCount() const override;
+	void read(const unsigned int & page, uint8_t data[PAGE_SIZE]) override;
+	bool program(const unsigned int & page, const uint8_t data[PAGE_SIZE]) override;
+	bool eraseAndProgram(const unsigned int & page, const uint8_t data[PAGE_SIZE]) override;
+	
+	/// \brief
+	/// Returns the number of failed writes
+	unsigned int getErrors();
+};
+
+#endif // SAM3XFLASHPAGES_HPP
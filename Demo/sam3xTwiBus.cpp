@@ -0,0 +1,115 @@
+#include "sam3xTwiBus.hpp"
+
+sam3xTwiBus::sam3xTwiBus(const peripheral & which, const uint32_t & frequencyHz){
+	if(which == peripheral::TWI_0){
+		twi = TWI0;
+		PMC->PMC_PCER0 = 1 << ID_TWI0;
+		PIOA->PIO_PDR = PIO_PA17A_TWD0 | PIO_PA18A_TWCK0;
+		PIOA->PIO_ABSR &= ~(PIO_PA17A_TWD0 | PIO_PA18A_TWCK0);
+	}else{
+		twi = TWI1;
+		PMC->PMC_PCER0 = 1 << ID_TWI1;
+		PIOB->PIO_PDR = PIO_PB12A_TWD1 | PIO_PB13A_TWCK1;
+		PIOB->PIO_ABSR &= ~(PIO_PB12A_TWD1 | PIO_PB13A_TWCK1);
+	}
+	twi->TWI_PTCR = TWI_PTCR_RXTDIS | TWI_PTCR_TXTDIS;
+	twi->TWI_IDR = ~0u;
+	twi->TWI_CR = TWI_CR_SWRST;
+	twi->TWI_RHR;
+	twi->TWI_CR = TWI_CR_SVDIS | TWI_CR_MSDIS;
+	twi->TWI_CR = TWI_CR_MSEN;
+	setFrequency(frequencyHz);
+}
+
+// Low and high time are ((DIV * 2^CKDIV) + 4) master clocks each. Fast-mode
+// needs at least 1.3 us low, so the low time gets 53% of the period: at
+// 400 kHz the 210 clock period is 111 clocks low and 99 high, 1.32 us low
+// and 1.18 us high.
+void sam3xTwiBus::setFrequency(const uint32_t & frequencyHz){
+	uint32_t frequency = frequencyHz > 400000 ? 400000 : frequencyHz;
+	uint32_t period = MASTER_CLOCK_HZ / frequency;
+	uint32_t low = (period * 53) / 100 - 4;
+	uint32_t high = period - (low + 4) - 4;
+	uint32_t ckdiv = 0;
+	while(low > 255 && ckdiv < 7){
+		low = (low + 1) / 2;
+		high = (high + 1) / 2;
+		++ckdiv;
+	}
+	twi->TWI_CWGR = TWI_CWGR_CLDIV(low) | TWI_CWGR_CHDIV(high) | TWI_CWGR_CKDIV(ckdiv);
+}
+
+bool sam3xTwiBus::waitFor(const uint32_t & flag){
+	for(uint32_t i = 0; i < TIMEOUT_POLLS; i++){
+		uint32_t status = twi->TWI_SR;
+		if(status & TWI_SR_NACK){
+			++errors;
+			return false;
+		}
+		if(status & flag){
+			return true;
+		}
+	}
+	++errors;
+	return false;
+}
+
+void sam3xTwiBus::write(uint_fast8_t address, const uint8_t data[], size_t count){
+	twi->TWI_MMR = TWI_MMR_DADR(address);
+	twi->TWI_IADR = 0;
+	if(count == 0){
+		twi->TWI_CR = TWI_CR_QUICK;
+		waitFor(TWI_SR_TXCOMP);
+		return;
+	}
+	for(size_t i = 0; i < count; i++){
+		twi->TWI_THR = data[i];
+		if(!waitFor(TWI_SR_TXRDY)){
+			return;
+		}
+	}
+	twi->TWI_CR = TWI_CR_STOP;
+	waitFor(TWI_SR_TXCOMP);
+}
+
+// STOP has to be requested while the last byte is being received, a single
+// byte read asks for START and STOP at once.
+void sam3xTwiBus::transferRead(uint8_t data[], size_t count){
+	if(count == 1){
+		twi->TWI_CR = TWI_CR_START | TWI_CR_STOP;
+	}else{
+		twi->TWI_CR = TWI_CR_START;
+	}
+	for(size_t i = 0; i < count; i++){
+		if(i == count - 1 && count > 1){
+			twi->TWI_CR = TWI_CR_STOP;
+		}
+		if(!waitFor(TWI_SR_RXRDY)){
+			return;
+		}
+		data[i] = twi->TWI_RHR;
+	}
+	waitFor(TWI_SR_TXCOMP);
+}
+
+void sam3xTwiBus::read(uint_fast8_t address, uint8_t data[], size_t count){
+	if(count == 0){
+		return;
+	}
+	twi->TWI_MMR = TWI_MMR_DADR(address) | TWI_MMR_MREAD;
+	twi->TWI_IADR = 0;
+	transferRead(data, count);
+}
+
+void sam3xTwiBus::readRegisters(uint_fast8_t address, uint8_t startRegister, uint8_t data[], size_t count){
+	if(count == 0){
+		return;
+	}
+	twi->TWI_MMR = TWI_MMR_DADR(address) | TWI_MMR_MREAD | TWI_MMR_IADRSZ_1_BYTE;
+	twi->TWI_IADR = startRegister;
+	transferRead(data, count);
+}
+
+unsigned int sam3xTwiBus::getErrors(){
+	return errors;
+}
@@ -0,0 +1,49 @@
+#ifndef SAM3XTWIBUS_HPP
+#define SAM3XTWIBUS_HPP
+#include "hwlib.hpp"
+#include "i2cRegisterBus.hpp"
+
+/// \brief
+/// I2C master on one of the two TWI peripherals of the SAM3X8E
+/// \details
+/// TWI0 is on the SDA1/SCL1 pins (PA17/PA18), TWI1 on SDA/SCL (PB12/PB13,
+/// Due pins 20/21). The peripheral generates the clock, start, stop and
+/// acknowledge timing itself, by default in 400 kHz Fast-mode.
+///
+/// readRegisters() sends the register address as TWI internal address, so
+/// the read follows with a repeated start and no other master can get in
+/// between. A device that does not acknowledge ends the transfer and is
+/// counted in getErrors(), as is a transfer that does not finish in time.
+class sam3xTwiBus : public i2cRegisterBus{
+public:
+	enum class peripheral { TWI_0, TWI_1 };
+	
+private:
+	Twi * twi;
+	unsigned int errors = 0;
+	
+	static const uint32_t MASTER_CLOCK_HZ = 84000000;
+	static const uint32_t TIMEOUT_POLLS = 100000;
+	
+	bool waitFor(const uint32_t & flag);
+	void transferRead(uint8_t data[], size_t count);
+	
+public:
+	/// \brief
+	/// Enables the peripheral and its pins and sets the bus speed
+	sam3xTwiBus(const peripheral & which, const uint32_t & frequencyHz = 400000);
+	
+	/// \brief
+	/// Sets the bus speed, at most 400 kHz
+	void setFrequency(const uint32_t & frequencyHz);
+	
+	void write(uint_fast8_t address, const uint8_t data[], size_t count) override;
+	void read(uint_fast8_t address, uint8_t data[], size_t count) override;
+	void readRegisters(uint_fast8_t address, uint8_t startRegister, uint8_t data[], size_t count) override;
+	
+	/// \brief
+	/// Returns the number of not acknowledged or timed out transfers
+	unsigned int getErrors();
+};
+
+#endif // SAM3XTWIBUS_HPP
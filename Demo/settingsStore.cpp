@@ -0,0 +1,221 @@
+#include "settingsStore.hpp"
+
+uint16_t settingsStore::crc16(const uint8_t data[], const size_t & length, uint16_t crc){
+	for(size_t i = 0; i < length; i++){
+		crc ^= uint16_t(data[i]) << 8;
+		for(int bit = 0; bit < 8; bit++){
+			crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	}
+	return crc;
+}
+
+uint32_t settingsStore::getSequence(const uint8_t page[PAGE_SIZE]){
+	return uint32_t(page[0]) | uint32_t(page[1]) << 8 | uint32_t(page[2]) << 16 | uint32_t(page[3]) << 24;
+}
+
+// Writes the record at offset, returns the offset after it
+unsigned int settingsStore::putRecord(uint8_t page[PAGE_SIZE], const unsigned int & offset, const entry & record){
+	uint8_t * out = page + offset;
+	out[0] = record.key;
+	out[1] = record.version;
+	out[2] = record.length;
+	for(unsigned int i = 0; i < record.length; i++){
+		out[3 + i] = record.data[i];
+	}
+	uint16_t crc = crc16(out, 3 + record.length);
+	out[3 + record.length] = crc >> 8;
+	out[4 + record.length] = crc & 0xFF;
+	return offset + RECORD_OVERHEAD + record.length;
+}
+
+settingsStore::entry * settingsStore::find(const uint8_t & key){
+	for(unsigned int i = 0; i < entryCount; i++){
+		if(entries[i].key == key){
+			return &entries[i];
+		}
+	}
+	return NULL;
+}
+
+// Reads the records of a page into the entries, returns the offset after the
+// last good record or PAGE_SIZE when a bad record was found
+unsigned int settingsStore::loadPage(const unsigned int & page){
+	uint8_t data[PAGE_SIZE];
+	pages.read(page, data);
+	unsigned int offset = HEADER_SIZE;
+	while(offset + RECORD_OVERHEAD <= PAGE_SIZE && data[offset] != NO_KEY){
+		const uint8_t * in = data + offset;
+		unsigned int length = in[2];
+		if(length > MAX_DATA || offset + RECORD_OVERHEAD + length > PAGE_SIZE){
+			return PAGE_SIZE;
+		}
+		uint16_t crc = crc16(in, 3 + length);
+		if(in[3 + length] != crc >> 8 || in[4 + length] != (crc & 0xFF)){
+			return PAGE_SIZE;
+		}
+		entry * record = find(in[0]);
+		if(record == NULL){
+			if(entryCount >= MAX_KEYS){
+				return PAGE_SIZE;
+			}
+			record = &entries[entryCount++];
+			record->key = in[0];
+		}
+		record->version = in[1];
+		record->length = length;
+		for(unsigned int i = 0; i < length; i++){
+			record->data[i] = in[3 + i];
+		}
+		offset += RECORD_OVERHEAD + length;
+	}
+	return offset;
+}
+
+unsigned int settingsStore::load(){
+	entryCount = 0;
+	activePage = -1;
+	sequence = 0;
+	writeOffset = PAGE_SIZE;
+	int previousPage = -1;
+	uint32_t previousSequence = 0;
+	uint8_t header[PAGE_SIZE];
+	for(unsigned int page = 0; page < pages.getPageCount(); page++){
+		pages.read(page, header);
+		uint32_t pageSequence = getSequence(header);
+		if(pageSequence == NO_SEQUENCE){
+			continue;
+		}
+		if(activePage < 0 || pageSequence > sequence){
+			previousPage = activePage;
+			previousSequence = sequence;
+			activePage = page;
+			sequence = pageSequence;
+		}else if(previousPage < 0 || pageSequence > previousSequence){
+			previousPage = page;
+			previousSequence = pageSequence;
+		}
+	}
+	if(previousPage >= 0){
+		loadPage(previousPage);
+	}
+	if(activePage >= 0){
+		writeOffset = loadPage(activePage);
+	}
+	return entryCount;
+}
+
+bool settingsStore::get(const uint8_t & key, const uint8_t & version, void * data, const size_t & length){
+	entry * record = find(key);
+	if(record == NULL || record->version != version || record->length != length){
+		return false;
+	}
+	uint8_t * out = static_cast<uint8_t *>(data);
+	for(unsigned int i = 0; i < length; i++){
+		out[i] = record->data[i];
+	}
+	return true;
+}
+
+bool settingsStore::set(const uint8_t & key, const uint8_t & version, const void * data, const size_t & length){
+	if(length > MAX_DATA || key == NO_KEY){
+		return false;
+	}
+	const uint8_t * in = static_cast<const uint8_t *>(data);
+	entry * record = find(key);
+	if(record != NULL && record->version == version && record->length == length){
+		bool same = true;
+		for(unsigned int i = 0; same && i < length; i++){
+			same = record->data[i] == in[i];
+		}
+		if(same){
+			return true;
+		}
+	}
+	if(record == NULL){
+		if(entryCount >= MAX_KEYS){
+			return false;
+		}
+		record = &entries[entryCount++];
+		record->key = key;
+	}
+	record->version = version;
+	record->length = length;
+	for(unsigned int i = 0; i < length; i++){
+		record->data[i] = in[i];
+	}
+	return append(*record);
+}
+
+bool settingsStore::verify(const unsigned int & page, const uint8_t data[PAGE_SIZE]){
+	uint8_t check[PAGE_SIZE];
+	pages.read(page, check);
+	for(unsigned int i = 0; i < PAGE_SIZE; i++){
+		if(check[i] != data[i]){
+			return false;
+		}
+	}
+	return true;
+}
+
+bool settingsStore::append(const entry & record){
+	if(activePage < 0 || writeOffset + RECORD_OVERHEAD + record.length > PAGE_SIZE){
+		return compact();
+	}
+	uint8_t data[PAGE_SIZE];
+	pages.read(activePage, data);
+	unsigned int end = putRecord(data, writeOffset, record);
+	if(!pages.program(activePage, data) || !verify(activePage, data)){
+		// the rest of this page can not be trusted anymore
+		writeOffset = PAGE_SIZE;
+		return false;
+	}
+	writeOffset = end;
+	++appends;
+	return true;
+}
+
+// Starts the next page with the latest record of every key, a page that
+// fails is skipped
+bool settingsStore::compact(){
+	uint8_t data[PAGE_SIZE];
+	for(unsigned int i = 0; i < PAGE_SIZE; i++){
+		data[i] = 0xFF;
+	}
+	uint32_t next = activePage < 0 ? 0 : sequence + 1;
+	for(unsigned int i = 0; i < HEADER_SIZE; i++){
+		data[i] = next >> (i * 8);
+	}
+	unsigned int offset = HEADER_SIZE;
+	for(unsigned int i = 0; i < entryCount; i++){
+		offset = putRecord(data, offset, entries[i]);
+	}
+	unsigned int page = activePage < 0 ? 0 : activePage + 1;
+	for(unsigned int tries = 0; tries < pages.getPageCount(); tries++, page++){
+		page %= pages.getPageCount();
+		if(int(page) == activePage && pages.getPageCount() > 1){
+			continue;
+		}
+		++erases;
+		if(pages.eraseAndProgram(page, data) && verify(page, data)){
+			activePage = page;
+			sequence = next;
+			writeOffset = offset;
+			++appends;
+			return true;
+		}
+	}
+	return false;
+}
+
+unsigned int settingsStore::getAppends(){
+	return appends;
+}
+
+unsigned int settingsStore::getErases(){
+	return erases;
+}
+
+int settingsStore::getActivePage(){
+	return activePage;
+}
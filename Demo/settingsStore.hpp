@@ -0,0 +1,115 @@
+#ifndef SETTINGSSTORE_HPP
+#define SETTINGSSTORE_HPP
+#include "hwlib.hpp"
+#include "flashPages.hpp"
+
+/// \brief
+/// Keeps small settings in flash as an append-only log
+/// \details
+/// A setting is a key with a version and up to MAX_DATA bytes. Every change
+/// is appended to the active page as a record: key, version, length, data
+/// and a CRC-16 over all of those. A page starts with a sequence number, the
+/// page with the highest one is the active page. When it is full, the latest
+/// record of every key is written to the next page with the next sequence
+/// number. The pages are used in turn, so they wear equally.
+///
+/// load() reads the two newest pages once, the older first. All settings
+/// are kept in RAM after that, get() does not touch the flash. A record with
+/// a wrong CRC, from a write that was cut short, ends the page: what came
+/// before it is kept. Because the page before the active one is loaded too,
+/// a cut short copy to a new page loses nothing.
+///
+/// The version is chosen by the user of a key. Changing the layout of the
+/// data means a new version, get() ignores a record of another version.
+class settingsStore{
+public:
+	static const unsigned int MAX_KEYS = 8;
+	static const unsigned int MAX_DATA = 24;
+	
+private:
+	static const unsigned int PAGE_SIZE = flashPages::PAGE_SIZE;
+	static const unsigned int HEADER_SIZE = 4;
+	static const unsigned int RECORD_OVERHEAD = 5;
+	static const uint8_t NO_KEY = 0xFF;
+	static const uint32_t NO_SEQUENCE = 0xFFFFFFFF;
+	
+	static_assert(HEADER_SIZE + MAX_KEYS * (RECORD_OVERHEAD + MAX_DATA) <= PAGE_SIZE, "all keys have to fit in one page");
+	
+	struct entry{
+		uint8_t key;
+		uint8_t version;
+		uint8_t length;
+		uint8_t data[MAX_DATA];
+	};
+	
+	flashPages & pages;
+	entry entries[MAX_KEYS];
+	unsigned int entryCount = 0;
+	int activePage = -1;
+	uint32_t sequence = 0;
+	unsigned int writeOffset = PAGE_SIZE;
+	unsigned int appends = 0;
+	unsigned int erases = 0;
+	
+	static uint32_t getSequence(const uint8_t page[PAGE_SIZE]);
+	static unsigned int putRecord(uint8_t page[PAGE_SIZE], const unsigned int & offset, const entry & record);
+	entry * find(const uint8_t & key);
+	unsigned int loadPage(const unsigned int & page);
+	bool append(const entry & record);
+	bool compact();
+	bool verify(const unsigned int & page, const uint8_t data[PAGE_SIZE]);
+	
+public:
+	settingsStore(flashPages & pages):
+		pages(pages)
+	{}
+	
+	/// \brief
+	/// Reads the settings from flash, returns the number of keys found
+	unsigned int load();
+	
+	/// \brief
+	/// Copies a setting to data
+	/// \details
+	/// Returns false, and leaves data alone, when the key is not stored or
+	/// was stored with another version or length.
+	bool get(const uint8_t & key, const uint8_t & version, void * data, const size_t & length);
+	
+	/// \brief
+	/// Stores a setting
+	/// \details
+	/// An unchanged setting is not written again. A change appends one
+	/// record, or copies the settings to the next page when the active page
+	/// is full. Returns false when the flash could not be written, when
+	/// length is larger than MAX_DATA, key is 0xFF or all keys are in use;
+	/// the new value is kept in RAM when only the flash write failed.
+	bool set(const uint8_t & key, const uint8_t & version, const void * data, const size_t & length);
+	
+	template<typename T>
+	bool get(const uint8_t & key, const uint8_t & version, T & value){
+		return get(key, version, &value, sizeof(T));
+	}
+	
+	template<typename T>
+	bool set(const uint8_t & key, const uint8_t & version, const T & value){
+		return set(key, version, &value, sizeof(T));
+	}
+	
+	/// \brief
+	/// Returns the CRC-16/CCITT of data, starting from crc
+	static uint16_t crc16(const uint8_t data[], const size_t & length, uint16_t crc = 0xFFFF);
+	
+	/// \brief
+	/// Returns the number of records appended since construction
+	unsigned int getAppends();
+	
+	/// \brief
+	/// Returns the number of pages erased since construction
+	unsigned int getErases();
+	
+	/// \brief
+	/// Returns the active page, -1 when nothing is stored
+	int getActivePage();
+};
+
+#endif // SETTINGSSTORE_HPP
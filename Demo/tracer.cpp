@@ -0,0 +1,140 @@
+#include "tracer.hpp"
+
+#ifdef __SAM3X8E__
+
+tracer::tracer(){
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	clear();
+}
+
+uint32_t tracer::now(){
+	return DWT->CYCCNT;
+}
+
+uint32_t tracer::getTicksPerUs(){
+	return 84;
+}
+
+#else
+
+#include <chrono>
+
+tracer::tracer(){
+	clear();
+}
+
+uint32_t tracer::now(){
+	return uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint32_t tracer::getTicksPerUs(){
+	return 1000;
+}
+
+#endif
+
+unsigned int tracer::bucket(const uint32_t & us){
+	unsigned int b = 0;
+	for(uint32_t value = us; value > 0 && b < BUCKETS - 1; value >>= 1){
+		++b;
+	}
+	return b;
+}
+
+int tracer::addSpan(const char * name){
+	if(spanCount >= MAX_SPANS){
+		return -1;
+	}
+	names[spanCount] = name;
+	return spanCount++;
+}
+
+void tracer::record(const int & span, const uint32_t & duration){
+	if(!enabled || span < 0 || span >= int(spanCount)){
+		return;
+	}
+	events[nextEvent].duration = duration;
+	events[nextEvent].span = span;
+	nextEvent = (nextEvent + 1) % EVENTS;
+	if(eventCount < EVENTS){
+		++eventCount;
+	}
+	++buckets[span][bucket(duration / getTicksPerUs())];
+	++counts[span];
+	if(duration > maxTicks[span]){
+		maxTicks[span] = duration;
+	}
+}
+
+void tracer::clear(){
+	nextEvent = 0;
+	eventCount = 0;
+	for(unsigned int s = 0; s < MAX_SPANS; s++){
+		for(unsigned int b = 0; b < BUCKETS; b++){
+			buckets[s][b] = 0;
+		}
+		counts[s] = 0;
+		maxTicks[s] = 0;
+	}
+}
+
+void tracer::setEnabled(const bool & on){
+	enabled = on;
+}
+
+uint32_t tracer::getCount(const int & span){
+	return span >= 0 && span < int(spanCount) ? counts[span] : 0;
+}
+
+uint32_t tracer::getMaxUs(const int & span){
+	return span >= 0 && span < int(spanCount) ? maxTicks[span] / getTicksPerUs() : 0;
+}
+
+uint32_t tracer::getBucket(const int & span, const unsigned int & b){
+	return span >= 0 && span < int(spanCount) && b < BUCKETS ? buckets[span][b] : 0;
+}
+
+// Sorts a copy of the durations of the span, only done when asked for
+bool tracer::getPercentiles(const int & span, uint32_t & p50Us, uint32_t & p99Us){
+	uint32_t sorted[EVENTS];
+	unsigned int n = 0;
+	for(unsigned int i = 0; i < eventCount; i++){
+		if(events[i].span != span){
+			continue;
+		}
+		uint32_t duration = events[i].duration;
+		unsigned int j = n++;
+		for(; j > 0 && sorted[j - 1] > duration; j--){
+			sorted[j] = sorted[j - 1];
+		}
+		sorted[j] = duration;
+	}
+	if(n == 0){
+		return false;
+	}
+	p50Us = sorted[(n - 1) * 50 / 100] / getTicksPerUs();
+	p99Us = sorted[(n - 1) * 99 / 100] / getTicksPerUs();
+	return true;
+}
+
+void tracer::dump(hwlib::ostream & out){
+	out << "span: count p50 p99 max (us)\n";
+	for(unsigned int s = 0; s < spanCount; s++){
+		uint32_t p50 = 0;
+		uint32_t p99 = 0;
+		getPercentiles(s, p50, p99);
+		out << names[s] << ": " << int(counts[s]) << ' ' << int(p50) << ' ' << int(p99) << ' ' << int(getMaxUs(s)) << '\n';
+		for(unsigned int b = 0; b < BUCKETS; b++){
+			if(buckets[s][b] == 0){
+				continue;
+			}
+			if(b == BUCKETS - 1){
+				out << "  >=" << int(1ul << (b - 1));
+			}else{
+				out << "  <" << int(1ul << b);
+			}
+			out << "us " << int(buckets[s][b]) << '\n';
+		}
+	}
+}
@@ -0,0 +1,132 @@
+#ifndef TRACER_HPP
+#define TRACER_HPP
+#include "hwlib.hpp"
+
+/// \brief
+/// Times named spans of code into a ring buffer and histograms
+/// \details
+/// On the Arduino Due the time comes from the DWT cycle counter of the
+/// Cortex-M3: 84 ticks per microsecond, read in a single load. On the host
+/// a monotonic clock with 1000 ticks per microsecond is used. Tick counts
+/// are 32 bits and wrap, differences up to 51 seconds (on the Due) are
+/// right.
+///
+/// A span is added once with a name and then measured with end(span, start)
+/// or a traceScope. The start can be taken anywhere, so a span can run from
+/// a sensor read to the flush that showed its result. Every duration goes
+/// in a ring buffer of the last EVENTS durations, for the percentiles, and
+/// in a histogram per span with power-of-two microsecond buckets that counts
+/// everything since clear(). dump() prints count, p50, p99 and max per span
+/// and the non-empty buckets.
+class tracer{
+public:
+	static const unsigned int MAX_SPANS = 12;
+	static const unsigned int EVENTS = 256;
+	static const unsigned int BUCKETS = 24;
+	
+private:
+	struct event{
+		uint32_t duration;
+		uint8_t span;
+	};
+	
+	const char * names[MAX_SPANS];
+	unsigned int spanCount = 0;
+	event events[EVENTS];
+	unsigned int nextEvent = 0;
+	unsigned int eventCount = 0;
+	uint32_t buckets[MAX_SPANS][BUCKETS];
+	uint32_t counts[MAX_SPANS];
+	uint32_t maxTicks[MAX_SPANS];
+	bool enabled = true;
+	
+	static unsigned int bucket(const uint32_t & us);
+	
+public:
+	/// \brief
+	/// Starts the clock and clears all spans
+	tracer();
+	
+	/// \brief
+	/// Returns the current time in ticks
+	static uint32_t now();
+	
+	/// \brief
+	/// Returns the number of ticks per microsecond
+	static uint32_t getTicksPerUs();
+	
+	/// \brief
+	/// Adds a span, returns its number or -1 when MAX_SPANS are in use
+	/// \details
+	/// The name is not copied, it has to stay valid.
+	int addSpan(const char * name);
+	
+	/// \brief
+	/// Records the time from start, taken with now(), until now
+	void end(const int & span, const uint32_t & start){
+		record(span, now() - start);
+	}
+	
+	/// \brief
+	/// Records a duration in ticks
+	void record(const int & span, const uint32_t & duration);
+	
+	/// \brief
+	/// Forgets all recorded durations, the spans stay
+	void clear();
+	
+	/// \brief
+	/// Turns recording on or off, end() and record() do nothing when off
+	void setEnabled(const bool & on);
+	
+	/// \brief
+	/// Returns the number of durations of a span since clear()
+	uint32_t getCount(const int & span);
+	
+	/// \brief
+	/// Returns the longest duration of a span since clear(), in microseconds
+	uint32_t getMaxUs(const int & span);
+	
+	/// \brief
+	/// Gets the p50 and p99 of a span in microseconds
+	/// \details
+	/// Only the durations still in the ring buffer are used. Returns false
+	/// when there are none.
+	bool getPercentiles(const int & span, uint32_t & p50Us, uint32_t & p99Us);
+	
+	/// \brief
+	/// Returns the number of durations in a histogram bucket
+	/// \details
+	/// Bucket 0 holds durations under 1 us, bucket b durations from 2^(b-1)
+	/// up to 2^b us. The last bucket holds everything longer.
+	uint32_t getBucket(const int & span, const unsigned int & b);
+	
+	/// \brief
+	/// Prints the statistics of every span
+	void dump(hwlib::ostream & out);
+};
+
+/// \brief
+/// Records the time between its construction and destruction as a span
+/// \details
+/// Does nothing with a NULL tracer, so tracing can be left out by not
+/// giving a tracer.
+class traceScope{
+	tracer * trace;
+	int span;
+	uint32_t start;
+public:
+	traceScope(tracer * trace, const int & span):
+		trace(trace),
+		span(span),
+		start(trace != NULL ? tracer::now() : 0)
+	{}
+	
+	~traceScope(){
+		if(trace != NULL){
+			trace->end(span, start);
+		}
+	}
+};
+
+#endif // TRACER_HPP
@@ -16,6 +16,24 @@
 
 namespace max7219{
 	
+//Definitions, so the constants can be passed by reference
+const uint8_t ledMatrix::ADDR_NO_OP;
+const uint8_t ledMatrix::ADDR_DECODE;
+const uint8_t ledMatrix::ADDR_INTENSITY;
+const uint8_t ledMatrix::ADDR_SCAN_LIMIT;
+const uint8_t ledMatrix::ADDR_SHUTDOWN;
+const uint8_t ledMatrix::ADDR_DISPLAY_TEST;
+const uint8_t ledMatrix::SCAN_LIMIT_ALL;
+const uint8_t ledMatrix::DIGIT_COUNT;
+const uint8_t ledMatrix::DECODE_NONE;
+const uint8_t ledMatrix::DECODE_ALL;
+const uint8_t ledMatrix::CODE_B_DASH;
+const uint8_t ledMatrix::CODE_B_E;
+const uint8_t ledMatrix::CODE_B_H;
+const uint8_t ledMatrix::CODE_B_L;
+const uint8_t ledMatrix::CODE_B_P;
+const uint8_t ledMatrix::CODE_B_BLANK;
+const uint8_t ledMatrix::CODE_B_DECIMAL_POINT;
 
 max7219::ledMatrix::ledMatrix(){
 	initializeLatchedValue();
@@ -29,8 +47,12 @@ uint16_t max7219::ledMatrix::getLatchedValue(const unsigned int & i){
 }
 
 void max7219::ledMatrix::latchRegister(){
-	if((temporaryValue>>8) >= 0 && (temporaryValue>>8) <= 16){
-		latchedValue[temporaryValue>>8] = temporaryValue;
+	unsigned int addr = temporaryValue >> 8;
+	if(addr < REGISTER_COUNT){
+		latchedValue[addr] = temporaryValue;
+	}
+	if(addr >= ADDR_COL_1 && addr <= ADDR_COL_8){
+		dirtyDigits &= ~(1 << (addr-1));
 	}
 }
 
@@ -52,10 +74,71 @@ void max7219::ledMatrix::setTempValue(const uint16_t & data){
 	temporaryValue = data;
 }
 
+void max7219::ledMatrix::setBufferedValue(const uint8_t & digit, const uint8_t & data){
+	if(digit < ADDR_COL_1 || digit > ADDR_COL_8){
+		return;
+	}
+	bufferedValue[digit-1] = data;
+	if(data != uint8_t(latchedValue[digit] & 255)){
+		dirtyDigits |= (1 << (digit-1));
+	}else{
+		dirtyDigits &= ~(1 << (digit-1));
+	}
+}
+
+uint8_t max7219::ledMatrix::getBufferedValue(const uint8_t & digit){
+	if(digit < ADDR_COL_1 || digit > ADDR_COL_8){
+		return 0x00;
+	}
+	if(dirtyDigits & (1 << (digit-1))){
+		return bufferedValue[digit-1];
+	}
+	return latchedValue[digit] & 255;
+}
+
+uint8_t max7219::ledMatrix::getDirtyDigits(){
+	return dirtyDigits;
+}
+
+uint8_t max7219::ledMatrix::getDecodeMode(){
+	return decodeMode;
+}
+
+void max7219::ledMatrix::setDecodeMode(const uint8_t & mode){
+	decodeMode = mode;
+}
+
+uint8_t max7219::ledMatrix::getScanLimit(){
+	return scanLimit;
+}
+
+void max7219::ledMatrix::setScanLimit(const uint8_t & limit){
+	scanLimit = limit > SCAN_LIMIT_ALL ? SCAN_LIMIT_ALL : limit;
+}
+
+bool max7219::ledMatrix::isActiveDigit(const uint8_t & digit){
+	return digit >= ADDR_COL_1 && digit <= scanLimit + 1;
+}
+
+uint8_t max7219::ledMatrix::getContentScanLimit(){
+	for(uint8_t digit = ADDR_COL_8; digit > ADDR_COL_1; --digit){
+		uint8_t data = getBufferedValue(digit);
+		bool decoded = decodeMode & (1 << (digit-1));
+		if(decoded ? data != CODE_B_BLANK : data != DATA_BLANK){
+			return digit-1;
+		}
+	}
+	return 0;
+}
+
 void max7219::ledMatrix::initializeLatchedValue(){
 	for(int i = 0; i < REGISTER_COUNT; i++){
 		latchedValue[i] = 0x00;
 	}
+	for(int i = 0; i < DIGIT_COUNT; i++){
+		bufferedValue[i] = 0x00;
+	}
+	dirtyDigits = 0x00;
 }
 
 }
\ No newline at end of file
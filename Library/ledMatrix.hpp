@@ -61,7 +61,8 @@ namespace max7219
 			/// 0x01 - 0x08 = collumn registers, these will display the actual leds
 			const static uint8_t ADDR_COL_8 = 0x08;
 			/// \brief
-			/// 0x09 = decode register, used for number displays (not implemented)
+			/// 0x09 = decode register, selects Code B decoding per digit for
+			/// number displays
 			const static uint8_t ADDR_DECODE = 0x09;
 			/// \brief
 			/// 0x0A = intensity register, setting the brightness of the screen
@@ -84,6 +85,28 @@ namespace max7219
 			const static uint8_t DISPLAY_TEST_ON = 0x01;
 			const static uint8_t DISPLAY_TEST_OFF = 0x00;
 			
+			/* 		DECODE MODE 	*/
+			/// \brief
+			/// Number of digit (collumn) registers on a single chip
+			const static uint8_t DIGIT_COUNT = 0x08;
+			/// \brief
+			/// Decode register value, no digit is decoded (matrix mode)
+			const static uint8_t DECODE_NONE = 0x00;
+			/// \brief
+			/// Decode register value, all digits are Code B decoded
+			const static uint8_t DECODE_ALL = 0xFF;
+			/// \brief
+			/// Code B characters 0x00 - 0x09 are the digits themselves
+			const static uint8_t CODE_B_DASH = 0x0A;
+			const static uint8_t CODE_B_E = 0x0B;
+			const static uint8_t CODE_B_H = 0x0C;
+			const static uint8_t CODE_B_L = 0x0D;
+			const static uint8_t CODE_B_P = 0x0E;
+			const static uint8_t CODE_B_BLANK = 0x0F;
+			/// \brief
+			/// Or'ed with a Code B character to light the decimal point
+			const static uint8_t CODE_B_DECIMAL_POINT = 0x80;
+			
 			/// \brief 
 			/// Construct a ledMatrix with initialized register values
 			/// \details
@@ -110,6 +133,9 @@ namespace max7219
 			/// array indexes.
 			///
 			/// This function does not reset current temporary value.
+			///
+			/// Latching a digit register clears its dirty state, the latest
+			/// write to the chip always wins over a buffered value.
 			void latchRegister();
 
 			/// \brief
@@ -128,9 +154,74 @@ namespace max7219
 			/// Does not latch previous set temporary value.
 			void setTempValue(const uint16_t & data);
 			
+			/// \brief
+			/// Stores data for a digit register without sending it
+			/// \details
+			/// Digit is 1-based (1 - 8), other values are ignored. Digits
+			/// beyond the scan limit are buffered too, so raising the limit
+			/// later shows them. The digit is marked dirty only if data
+			/// differs from the latched value, so writing the same value
+			/// again costs nothing on the next flush.
+			void setBufferedValue(const uint8_t & digit, const uint8_t & data);
+			
+			/// \brief
+			/// Returns the buffered value of a digit register
+			/// \details
+			/// If the digit is dirty the buffered value is returned, otherwise
+			/// the latched value is returned.
+			uint8_t getBufferedValue(const uint8_t & digit);
+			
+			/// \brief
+			/// Returns a bitmask of digits waiting to be flushed
+			/// \details
+			/// Bit 0 stands for digit register 1, bit 7 for digit register 8.
+			uint8_t getDirtyDigits();
+			
+			/// \brief
+			/// Returns the decode mode this chip should be configured with
+			uint8_t getDecodeMode();
+			
+			/// \brief
+			/// Sets the decode mode this chip should be configured with
+			/// \details
+			/// This only stores the value, the ledMatrixSet sends it to the
+			/// chip.
+			void setDecodeMode(const uint8_t & mode);
+			
+			/// \brief
+			/// Returns the scan limit this chip should be configured with
+			uint8_t getScanLimit();
+			
+			/// \brief
+			/// Sets the scan limit this chip should be configured with
+			/// \details
+			/// Limit is the 0-based index of the last scanned digit, values
+			/// higher than SCAN_LIMIT_ALL are clamped. Dirty digits beyond
+			/// the new limit stay dirty until the limit includes them again.
+			/// This only stores the value, the ledMatrixSet sends it to the
+			/// chip.
+			void setScanLimit(const uint8_t & limit);
+			
+			/// \brief
+			/// Returns true if the 1-based digit register is within the scan
+			/// limit
+			bool isActiveDigit(const uint8_t & digit);
+			
+			/// \brief
+			/// Returns the smallest scan limit that still shows all content
+			/// \details
+			/// Looks at the buffered value of every digit, the highest digit
+			/// that is not empty determines the limit. In decode mode a 
+			/// Code B blank counts as empty, unless its decimal point is lit.
+			uint8_t getContentScanLimit();
+			
 		private:
 			uint16_t latchedValue[REGISTER_COUNT];
 			uint16_t temporaryValue = 0x00;
+			uint8_t bufferedValue[DIGIT_COUNT];
+			uint8_t dirtyDigits = 0x00;
+			uint8_t decodeMode = DECODE_NONE;
+			uint8_t scanLimit = SCAN_LIMIT_ALL;
 			
 
 			/// \brief
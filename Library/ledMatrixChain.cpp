@@ -0,0 +1,456 @@
+// ==========================================================================
+//
+// File      : ledMatrixChain.cpp
+// Part of   : C++ max7219 ledMatrix library
+// Author    : Jens Bouman
+// Github    : https://github.com/JensBouman/max7219
+// Copyright : jens.bouman@student.hu.nl 2018
+//
+//
+//Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file Boost V1.0.txt or copy at 
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+#include "ledMatrixChain.hpp"
+
+namespace max7219 {
+	
+	ledMatrixChain::ledMatrixChain(spiBusLed & spiBus, ledMatrix ledMatrices[], const unsigned int & count):
+		ledMatrices(ledMatrices),
+		count(count),
+		spiBus(spiBus)
+	{}
+	
+	unsigned int ledMatrixChain::getScreenCount(){
+		return count;
+	}
+	
+	void ledMatrixChain::insertTempValue(const uint16_t & tmpValue){
+		for(int i = count-1; i > 0; --i){
+			ledMatrices[i].setTempValue(ledMatrices[i-1].getTempValue());
+		}
+		ledMatrices[0].setTempValue(tmpValue);
+	}
+	
+	void ledMatrixChain::latchAllRegisters(){
+		for(int i = count-1; i >= 0; --i){
+			ledMatrices[i].latchRegister();
+		}
+	}
+	
+	void ledMatrixChain::sendCommand(const uint8_t & registerAddr, const uint8_t & dataOut, uint16_t & dataIn, const bool & buffer){
+		uint16_t packet16bit = spiBusLed::makeDataArray(registerAddr, dataOut);
+		if(buffer){
+			insertTempValue(packet16bit);
+			spiBus.writeReadCommand(&packet16bit, &dataIn);
+		}else{
+			openComms();
+			insertTempValue(packet16bit);
+			spiBus.writeReadCommand(&packet16bit, &dataIn);
+			closeComms();
+		}
+	}
+	
+	void ledMatrixChain::sendCommandToScreen(const uint8_t & registerAddr, const uint8_t & dataOut, const unsigned int & screenN, uint16_t & dataIn, const bool & buffer){
+		for(unsigned int i = count; i > 0; --i){
+			if(i == screenN){
+				sendCommand(registerAddr, dataOut, dataIn, buffer);
+			}else{
+				sendCommand(0x00, 0x00, dataIn, buffer);
+			}
+		}
+	}
+	
+	void ledMatrixChain::sendDecodeModes(){
+		uint16_t dataIn = 0;
+		openComms();
+		for(int screen = count-1; screen >= 0; --screen){
+			sendCommand(ledMatrix::ADDR_DECODE, ledMatrices[screen].getDecodeMode(), dataIn);
+		}
+		closeComms();
+	}
+	
+	void ledMatrixChain::sendScanLimits(){
+		uint16_t dataIn = 0;
+		openComms();
+		for(int screen = count-1; screen >= 0; --screen){
+			sendCommand(ledMatrix::ADDR_SCAN_LIMIT, ledMatrices[screen].getScanLimit(), dataIn);
+		}
+		closeComms();
+	}
+	
+	uint8_t ledMatrixChain::getLastActiveDigit(){
+		uint8_t last = ledMatrix::ADDR_COL_1;
+		for(unsigned int i = 0; i < count; ++i){
+			if(ledMatrices[i].getScanLimit() + 1 > last){
+				last = ledMatrices[i].getScanLimit() + 1;
+			}
+		}
+		return last;
+	}
+	
+	void ledMatrixChain::pushLastSignal(){
+		openComms();
+		closeComms();
+	}
+	
+	void ledMatrixChain::cycleStep(){
+		uint16_t dataIn = 0;
+		int lastCollumn = getLastActiveDigit();
+		for(int collumn = 1; collumn <= lastCollumn; collumn++){
+			openComms();
+			
+			if(cycle){
+				uint8_t lastBit = ledMatrices[count-1].getLatchedValue(collumn) & 128;
+				for(int screen = count-1; screen > 0; --screen){
+					uint8_t dataOut = (ledMatrices[screen].getLatchedValue(collumn) << 1) | ((ledMatrices[screen-1].getLatchedValue(collumn) & 128) >> 7);
+					sendCommand(collumn, dataOut, dataIn);
+				}
+				uint8_t dataOut = (ledMatrices[0].getLatchedValue(collumn) << 1) | (lastBit >> 7);
+				sendCommand(collumn, dataOut, dataIn);
+			}else{
+				for(int screen = count-1; screen > 0; --screen){
+					uint8_t dataOut = (ledMatrices[screen].getLatchedValue(collumn) << 1) | ((ledMatrices[screen-1].getLatchedValue(collumn) & 128) >> 7);
+					sendCommand(collumn, dataOut, dataIn);
+				}
+				uint8_t dataOut = (ledMatrices[0].getLatchedValue(collumn) << 1 | 0);
+				sendCommand(collumn, dataOut, dataIn);
+			}
+			closeComms();
+		}
+		pushLastSignal();
+	}
+	
+	int_fast32_t ledMatrixChain::getCycleDelay(){
+		return cycleDelayNs;
+	}
+	
+	void ledMatrixChain::setCycleDelay(const int_fast32_t & tempDelay){
+		if(tempDelay < 0){
+			cycleDelayNs = 0;
+		}else{
+			cycleDelayNs = tempDelay;
+		}
+	}
+	
+	void ledMatrixChain::setCycle(const bool & tempCycle){
+		cycle = tempCycle;
+	}
+	
+	bool ledMatrixChain::getCycle(){
+		return cycle;
+	}
+	
+	ledMatrix ledMatrixChain::getLedMatrix(unsigned int screenN){
+		return (screenN <= count && screenN > 0) ? ledMatrices[screenN-1] : ledMatrices[0];
+	}
+	
+	void ledMatrixChain::closeComms(){
+		spiBus.waitHalfPeriod();
+		spiBus.closeComms();
+		spiBus.waitHalfPeriod();
+		latchAllRegisters();
+	}
+	
+	void ledMatrixChain::openComms(){
+		spiBus.openComms();
+	}
+	
+	void ledMatrixChain::setRegister(const unsigned int & screenN, const uint8_t & registerAddr, const uint8_t & data){
+		uint16_t dataIn = 0;
+		openComms();
+		sendCommandToScreen(registerAddr, data, screenN, dataIn);
+		closeComms();
+	}
+	
+	void ledMatrixChain::setRegisters(const uint8_t & registerAddr, const uint8_t data[], const bool selection[]){
+		uint16_t dataIn = 0;
+		openComms();
+		for(int screen = count-1; screen >= 0; --screen){
+			if(selection == nullptr || selection[screen]){
+				sendCommand(registerAddr, data[screen], dataIn);
+			}else{
+				sendCommand(ledMatrix::ADDR_NO_OP, 0x00, dataIn);
+			}
+		}
+		closeComms();
+	}
+	
+	void ledMatrixChain::resetRegisters(){
+		uint16_t dataIn = 0;
+		for(uint8_t i = 0; i < 16; ++i){
+			uint8_t registerData = 0x00;
+			if(i == max7219::ledMatrix::ADDR_SHUTDOWN){
+				registerData = max7219::ledMatrix::SHUTDOWN_OFF;
+			}else if(i == max7219::ledMatrix::ADDR_INTENSITY){
+				registerData = max7219::ledMatrix::INTENSITY_MAX;
+			}else if(i == max7219::ledMatrix::ADDR_SCAN_LIMIT){
+				registerData = max7219::ledMatrix::SCAN_LIMIT_ALL;
+			}else if(i == max7219::ledMatrix::ADDR_DISPLAY_TEST){
+				registerData = max7219::ledMatrix::DISPLAY_TEST_OFF;
+			}
+			openComms();
+			sendCommand(i, registerData, dataIn);
+			closeComms();
+		}
+		//make sure the data is pushed to the last ledMatrix
+		for(unsigned int i = 0; i < count; ++i){
+			openComms();
+			sendCommand(0x00, 0x00, dataIn);
+			closeComms();
+		}
+		for(unsigned int i = 0; i < count; ++i){
+			if(ledMatrices[i].getDecodeMode() != ledMatrix::DECODE_NONE){
+				sendDecodeModes();
+				break;
+			}
+		}
+		for(unsigned int i = 0; i < count; ++i){
+			if(ledMatrices[i].getScanLimit() != ledMatrix::SCAN_LIMIT_ALL){
+				sendScanLimits();
+				break;
+			}
+		}
+	}
+	
+	void ledMatrixChain::setScanLimit(const unsigned int & screenN, const uint8_t & limit){
+		if(screenN < 1 || screenN > count){
+			return;
+		}
+		ledMatrices[screenN-1].setScanLimit(limit);
+		sendScanLimits();
+	}
+	
+	void ledMatrixChain::fitScanLimits(){
+		for(unsigned int i = 0; i < count; ++i){
+			ledMatrices[i].setScanLimit(ledMatrices[i].getContentScanLimit());
+		}
+		sendScanLimits();
+		flush();
+	}
+	
+	void ledMatrixChain::setDecodeMode(const unsigned int & screenN, const uint8_t & mode){
+		if(screenN < 1 || screenN > count){
+			return;
+		}
+		ledMatrices[screenN-1].setDecodeMode(mode);
+		sendDecodeModes();
+	}
+	
+	void ledMatrixChain::setDigit(const unsigned int & screenN, const uint8_t & digit, const uint8_t & value, const bool & decimalPoint){
+		if(screenN < 1 || screenN > count){
+			return;
+		}
+		uint8_t data = decimalPoint ? (value | ledMatrix::CODE_B_DECIMAL_POINT) : value;
+		ledMatrices[screenN-1].setBufferedValue(digit, data);
+	}
+	
+	void ledMatrixChain::setFixedPoint(const unsigned int & screenN, const int32_t & value, const uint8_t & decimals){
+		if(screenN < 1 || screenN > count){
+			return;
+		}
+		uint8_t digits[ledMatrix::DIGIT_COUNT];
+		bool negative = value < 0;
+		uint32_t magnitude = negative ? uint32_t(-int64_t(value)) : uint32_t(value);
+		unsigned int used = 0;
+		do{
+			digits[used++] = magnitude % 10;
+			magnitude /= 10;
+		}while((magnitude > 0 || used <= decimals) && used < ledMatrix::DIGIT_COUNT);
+		if(negative && used < ledMatrix::DIGIT_COUNT){
+			digits[used++] = ledMatrix::CODE_B_DASH;
+			negative = false;
+		}
+		// With DIGIT_COUNT or more decimals the leading zero and its decimal
+		// point do not fit either
+		bool overflow = magnitude > 0 || negative || decimals >= ledMatrix::DIGIT_COUNT;
+		for(uint8_t i = 0; i < ledMatrix::DIGIT_COUNT; ++i){
+			uint8_t data = ledMatrix::CODE_B_BLANK;
+			if(overflow){
+				data = ledMatrix::CODE_B_DASH;
+			}else if(i < used){
+				data = digits[i];
+				if(decimals > 0 && i == decimals){
+					data |= ledMatrix::CODE_B_DECIMAL_POINT;
+				}
+			}
+			ledMatrices[screenN-1].setBufferedValue(i+1, data);
+		}
+	}
+	
+	void ledMatrixChain::setNumber(const unsigned int & screenN, const int32_t & value){
+		setFixedPoint(screenN, value, 0);
+	}
+	
+	void ledMatrixChain::flush(){
+		uint16_t dataIn = 0;
+		uint8_t lastDigit = getLastActiveDigit();
+		for(uint8_t digit = ledMatrix::ADDR_COL_1; digit <= lastDigit; ++digit){
+			uint8_t bit = 1 << (digit-1);
+			bool dirty = false;
+			for(unsigned int i = 0; i < count; ++i){
+				if((ledMatrices[i].getDirtyDigits() & bit) && ledMatrices[i].isActiveDigit(digit)){
+					dirty = true;
+					break;
+				}
+			}
+			if(!dirty){
+				continue;
+			}
+			openComms();
+			for(int screen = count-1; screen >= 0; --screen){
+				if((ledMatrices[screen].getDirtyDigits() & bit) && ledMatrices[screen].isActiveDigit(digit)){
+					sendCommand(digit, ledMatrices[screen].getBufferedValue(digit), dataIn);
+				}else{
+					sendCommand(ledMatrix::ADDR_NO_OP, 0x00, dataIn);
+				}
+			}
+			closeComms();
+		}
+	}
+	
+	void ledMatrixChain::printAllRegisters(){
+		for(unsigned int i = 0; i < count; ++i){
+			hwlib::cout << "Scherm " << i+1 << "\n" ;
+			ledMatrices[i].printRegisters();
+			hwlib::cout << "\n\n";
+		}
+	}
+	
+	bool ledMatrixChain::getPixel(const int & x, const int & y){
+		if(x < 0 || x >= int(count*8) || y < 0 || y >= ledMatrix::DIGIT_COUNT){
+			return false;
+		}
+		return (ledMatrices[x/8].getBufferedValue(y+1) >> (x%8)) & 1;
+	}
+	
+	uint8_t ledMatrixChain::blit(const sprite & image, const int & x, const int & y, const rasterOp & op){
+		uint8_t collision = 0;
+		unsigned int stride = (image.width + 7) / 8;
+		for(unsigned int line = 0; line < image.height && line < ledMatrix::DIGIT_COUNT; ++line){
+			int row = y + int(line);
+			if(row < 0 || row >= ledMatrix::DIGIT_COUNT){
+				continue;
+			}
+			for(unsigned int byte = 0; byte < stride; ++byte){
+				unsigned int pixels = image.width - byte*8;
+				uint8_t mask = pixels >= 8 ? 0xFF : uint8_t((1 << pixels) - 1);
+				uint8_t bits = image.lines[line*stride + byte] & mask;
+				int pixelX = x + int(byte*8);
+				int screen = pixelX >= 0 ? pixelX / 8 : -((7 - pixelX) / 8);
+				unsigned int shift = pixelX - screen*8;
+				uint16_t wideBits = uint16_t(bits) << shift;
+				uint16_t wideMask = uint16_t(mask) << shift;
+				for(int half = 0; half < 2; ++half, ++screen){
+					uint8_t partBits = uint8_t(wideBits >> (half*8));
+					uint8_t partMask = uint8_t(wideMask >> (half*8));
+					if(screen < 0 || screen >= int(count) || partMask == 0){
+						continue;
+					}
+					uint8_t data = ledMatrices[screen].getBufferedValue(row+1);
+					if(data & partBits){
+						collision |= (1 << line);
+					}
+					switch(op){
+						case rasterOp::COPY: data = (data & ~partMask) | partBits; break;
+						case rasterOp::OR: data |= partBits; break;
+						case rasterOp::AND: data &= partBits | ~partMask; break;
+						case rasterOp::XOR: data ^= partBits; break;
+					}
+					ledMatrices[screen].setBufferedValue(row+1, data);
+				}
+			}
+		}
+		return collision;
+	}
+	
+	void ledMatrixChain::setLed(const unsigned int & screenN, const uint8_t & collumn, const uint8_t & data, const bool & coordinates){
+		uint16_t dataIn = 0;
+		uint8_t dataOut = data;
+		if(coordinates == true){
+			if(data >= 1 && data <= 8){
+				dataOut = 1 << (data-1);
+			}else{
+				dataOut = 0x00;
+			}
+			dataOut = dataOut | uint8_t(ledMatrices[screenN-1].getLatchedValue(collumn) & 255);
+		}
+		if(collumn >= 1 && collumn <= 8 && ledMatrices[screenN-1].isActiveDigit(collumn)){
+			openComms();
+			sendCommandToScreen(collumn, dataOut, screenN, dataIn);
+			closeComms();
+			pushLastSignal();
+		}
+	}
+	
+	void ledMatrixChain::resetLedAt(const unsigned int & screenN, const int & collumn, const int & row){
+		uint16_t dataIn = 0;
+		uint8_t dataOut = 255;
+		if(row >= 1 && row <= 8){
+			dataOut &=  ~(1 << (row-1));
+		}else{
+			dataOut = 0x00;
+		}
+		dataOut = dataOut & uint8_t(ledMatrices[screenN-1].getLatchedValue(collumn) & 255);
+		if(collumn >= 1 && collumn <= 8 && ledMatrices[screenN-1].isActiveDigit(collumn)){
+			openComms();
+			sendCommandToScreen(collumn, dataOut, screenN, dataIn);
+			closeComms();
+			pushLastSignal();
+		}
+	}
+	
+	void ledMatrixChain::setLetter(const unsigned int & screenN, const char & letter){
+		uint16_t dataIn = 0;
+		auto & test = f[letter];
+		for(int i = 0; i < 8; i++){
+			if(!ledMatrices[screenN-1].isActiveDigit(i+1)){
+				continue;
+			}
+			uint8_t dataOut = 0;
+			for(int j = 0; j < 8; j++){
+				auto c = test[hwlib::location(j,i)];
+				dataOut = (dataOut << 1) | (c == hwlib::black);
+			}
+			openComms();
+			sendCommandToScreen(i+1, dataOut, screenN, dataIn);
+			closeComms();
+		}
+	}
+	
+	void ledMatrixChain::setWord(const char word[], const unsigned int & size){
+		unsigned int x = size > count ? count : size; //auto trim the word to fit the matrix set
+		for(unsigned int i = 0; i < x ; ++i){
+			setLetter(i+1, word[x-i-1]);
+		}
+	}
+	
+	void ledMatrixChain::setRow(const unsigned int screenN, const uint8_t & row){
+		uint16_t dataIn = 0;
+		for(int i = 0; i < 8; ++i){
+			if(!ledMatrices[screenN-1].isActiveDigit(i+1)){
+				continue;
+			}
+			uint16_t dataOut = (ledMatrices[screenN-1].getLatchedValue(i+1) & 255) | ((row >> i) & 1);
+			openComms();
+			sendCommandToScreen(i+1, dataOut, screenN, dataIn);
+			closeComms();
+		}
+		pushLastSignal();
+	}
+	
+	void ledMatrixChain::cycleSteps(const int & stepsN){
+		for(int i = stepsN; i > 0; --i){
+			cycleStep();
+			hwlib::wait_us(cycleDelayNs/1000);
+		}
+	}
+	
+	void ledMatrixChain::cycleSet(){
+		for(int i = count*8; i > 0; --i){
+			cycleStep();
+			hwlib::wait_us(cycleDelayNs/1000);
+		}
+	}
+}
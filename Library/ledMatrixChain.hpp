@@ -0,0 +1,373 @@
+// ==========================================================================
+//
+// File      : ledMatrixChain.hpp
+// Part of   : C++ max7219 ledMatrix library
+// Author    : Jens Bouman
+// Github    : https://github.com/JensBouman/max7219
+// Copyright : jens.bouman@student.hu.nl 2018
+//
+//
+//Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file Boost V1.0.txt or copy at 
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef LEDMATRIXCHAIN_HPP
+#define LEDMATRIXCHAIN_HPP
+#include "hwlib.hpp"
+#include "ledMatrix.hpp"
+#include "spiBusLed.hpp"
+#include "sprite.hpp"
+
+namespace max7219{
+	/// \brief
+	/// Size independent logic for daisy-chained max7219 chips
+	/// \details
+	/// This class does all the work for ledMatrixSet: building frames, 
+	/// keeping the shadow registers of every ledMatrix and encoding commands.
+	/// It works on an array of ledMatrices it does not own, so it is compiled
+	/// once no matter how many chain sizes a program uses.
+	///
+	/// n in the context of this class means the number of screens attached,
+	/// which is the count given to the constructor. Use ledMatrixSet to get
+	/// the storage for the ledMatrices.
+	class ledMatrixChain {
+		private:
+			ledMatrix * ledMatrices;
+			const unsigned int count;
+			spiBusLed & spiBus; //Custom made spi controller for 16bit 
+			int_fast32_t cycleDelayNs = 50; // in ns
+			bool cycle = true; //If true, cycle functions will overflow back
+			hwlib::font_default_8x8 f = hwlib::font_default_8x8(); //font
+			
+			/// \brief
+			/// Inserts tempvalue at first ledMatrix, and propogates the
+			/// previous value to next ledMatrices.
+			/// \details
+			/// Sets the temporary value of the last ledMatrix to the temporary
+			/// value of the one before it.
+			/// 
+			/// The first ledMatrix gets the newly inserted value.
+			///
+			/// The temporary value of the last ledMatrix will be discarded.
+			void insertTempValue(const uint16_t & tmpValue);
+			
+			/// \brief
+			/// Calls the latchRegister() method on each ledMatrix starting at 
+			/// n-1.
+			void latchAllRegisters();
+			
+			/// \brief
+			/// Makes a 16bit packet, sets it as temporary value and sends it
+			/// to the spiBus.
+			/// \details
+			/// Adds the registerAddr and dataOut together with the spiBusLed
+			/// makeDataArray() method, to build a correct packet.
+			///
+			/// It inserts that packet as temporary value, and sends it to the
+			/// spiBus writeReadCommand() function.
+			///
+			/// If the given buffer parameter is set to false, it triggers a
+			/// falling edge before sending the packet, and triggers a rising
+			/// edge after sending the packet. This also latches temporary
+			/// values.
+			/// Leave buffer = true to set your own rising and falling edges.
+			void sendCommand(const uint8_t & registerAddr, const uint8_t & dataOut, uint16_t & dataIn, const bool & buffer = true);
+			
+			/// \brief
+			/// Sends a command to given screen number, and 0x00 to all others at no-nop register.
+			/// \details
+			/// This function loops through all ledMatrices and calls 
+			/// sendCommand. when the iterator equals the given screen number,
+			/// it gives the actual data and register address, otherwise it 
+			/// sends 0x00 as both address and data.
+			/// 
+			/// It loops starting from i = n, towards i == 0.
+			void sendCommandToScreen(const uint8_t & registerAddr, const uint8_t & dataOut, const unsigned int & screenN, uint16_t & dataIn, const bool & buffer = true);
+			
+			/// \brief
+			/// Sends the configured decode mode of every screen in one frame
+			void sendDecodeModes();
+			
+			/// \brief
+			/// Sends the configured scan limit of every screen in one frame
+			void sendScanLimits();
+			
+			/// \brief
+			/// Returns the highest digit register scanned by any screen
+			/// \details
+			/// Digit registers above this value are dead on every screen, 
+			/// frames for them can be skipped.
+			uint8_t getLastActiveDigit();
+			
+			/// \brief
+			/// Triggers both a rising and falling edge and latches temporary
+			/// values.
+			void pushLastSignal();
+			
+			/// \brief
+			/// Pushes the all leds one collumn to the far end (towards n), and 
+			/// if cycle is true the overflow is added back on the first 
+			/// ledMatrix.
+			/// \details
+			/// Loops through each digit register within the scan limit of the
+			/// chain. It keeps the overflow bit
+			/// and then loops through the screens from the farthest (n) to 0.
+			/// Then the last shifting bit of the earlier screen gets added to
+			/// the bits from the currently iterated screen.
+			/// 
+			/// If cycle is true, then it sets the 0th screen with the overflowing bit.
+			/// If cycle is false, the 0th screen will be pushed a 0.
+			/// 
+			/// Once all bits are send to the correct screen, comms will be closed, to ensure smooth transition.
+			///
+			/// Afterwards, the push last signa will be sent to ensure latching to be done.
+			void cycleStep();
+
+		public:
+			/// \brief
+			/// Constructs the chain on given ledMatrices and spiBus
+			/// \details
+			/// The ledMatrices array must hold count elements and outlive the
+			/// chain. It is not touched by the constructor, so it may still
+			/// be under construction.
+			ledMatrixChain(spiBusLed & spiBus, ledMatrix ledMatrices[], const unsigned int & count);
+			
+			/// \brief
+			/// Returns the number of screens in the chain
+			unsigned int getScreenCount();
+			
+			/// \brief
+			/// Returns the current cycleDelay in ns
+			int_fast32_t getCycleDelay();
+			
+			/// \brief
+			/// Sets the cycle delay in ns to given parameter. If the number is
+			/// negative, it is set to 0. 
+			void setCycleDelay(const int_fast32_t & tempDelay);
+			
+			/// \brief
+			/// Sets the cycle overflow. If true, will add overflow from the 
+			/// nth screen to 0th screen.
+			void setCycle(const bool & tempCycle);
+			
+			/// \brief
+			/// Gets the cycle overflow.
+			bool getCycle();
+			
+			/// \brief
+			/// Returns the ledmatrix at given screen number. Screen number is 
+			/// 1-based, ledmatrices is 0-based, so minus 1.
+			ledMatrix getLedMatrix(unsigned int screenN);
+			
+			/// \brief
+			/// Triggers rising edge and latches register values on all 
+			/// ledMatrices
+			/// \details
+			/// Triggers rising edge on select pin through spiBus, after 
+			/// waiting a half period.
+			/// 
+			/// Also latches temporary register values on all ledMatrices
+			void closeComms();
+			
+			/// \brief
+			/// Sets a falling edge through spiBus openComms().
+			void openComms();
+			
+			/// \brief
+			/// Sets a register on given screen to given data
+			/// \details
+			/// Opens communication, uses sendCommandToScreen() method to send
+			/// the data to the correct screen and register and closes 
+			/// communication
+			void setRegister(const unsigned int & screenN, const uint8_t & registerAddr, const uint8_t & data);
+			
+			/// \brief
+			/// Sets a register on every screen to its own value in one frame
+			/// \details
+			/// data[0] is the value for screen 1, data[n-1] for screen n. If
+			/// selection is given, only screens for which it is true are
+			/// written, the others receive a no-op and keep their value.
+			void setRegisters(const uint8_t & registerAddr, const uint8_t data[], const bool selection[] = nullptr);
+			
+			/// \brief
+			/// Sets registers to their corresponding default values
+			/// \details
+			/// Loops through all 16 registers (0x14 and 0x15 aren't used, but 
+			/// will be set) and sets the correct value. This differs for the
+			/// shutdown, intensity, scan limit and test display registers.
+			/// Those registers get their special default value. Others get set
+			/// to 0x00.
+			///
+			/// After the registers are set, a 0x00 command is pushed n times,
+			/// to make sure that the temporary registers are all empty
+			///
+			/// If any screen has a decode mode configured through 
+			/// setDecodeMode() or a scan limit through setScanLimit(), those
+			/// are sent afterwards, one frame per register.
+			void resetRegisters();
+			
+			/// \brief
+			/// Sets the scan limit of given screen
+			/// \details
+			/// Limit is the 0-based index of the last digit that is scanned,
+			/// ledMatrix::SCAN_LIMIT_ALL scans all 8. Buffered writes to digits
+			/// beyond the limit are kept but flush() skips them, so partly 
+			/// populated modules don't pay for dead registers. Direct writes
+			/// like setLed() to those digits are refused.
+			///
+			/// Fewer scanned digits means every digit is lit a larger part of
+			/// the time, so the same brightness is reached with a lower 
+			/// intensity. All screens receive their own limit in one frame.
+			void setScanLimit(const unsigned int & screenN, const uint8_t & limit);
+			
+			/// \brief
+			/// Sets the scan limit of every screen to fit its content
+			/// \details
+			/// Uses ledMatrix::getContentScanLimit() on each screen and sends
+			/// all limits in one frame. Meant for bar-graphs and displays of 
+			/// which the used digits are known after drawing. Digits that
+			/// became active are flushed afterwards.
+			void fitScanLimits();
+			
+			/// \brief
+			/// Sets the decode mode of given screen
+			/// \details
+			/// Each bit of mode enables Code B decoding for one digit, bit 0
+			/// being digit register 1. The mode is remembered, so 
+			/// resetRegisters() restores it. All screens receive their own 
+			/// decode mode in a single frame.
+			void setDecodeMode(const unsigned int & screenN, const uint8_t & mode);
+			
+			/// \brief
+			/// Buffers a Code B character for a digit on given screen
+			/// \details
+			/// Digit 1 is the digit register 1, which is the rightmost digit
+			/// on most 7-segment modules. The value is only sent by flush(),
+			/// and only if it differs from what the chip already shows.
+			void setDigit(const unsigned int & screenN, const uint8_t & digit, const uint8_t & value, const bool & decimalPoint = false);
+			
+			/// \brief
+			/// Buffers a fixed-point number on given screen
+			/// \details
+			/// value is the number multiplied by 10^decimals, so 
+			/// setFixedPoint(1, 1234, 2) shows 12.34. The number is right
+			/// aligned, unused digits are blanked and a minus sign is shown as
+			/// a dash. If the number does not fit in the 8 digits, all digits
+			/// show a dash. So do 8 or more decimals, as there is no digit
+			/// left for the leading zero.
+			///
+			/// The screen needs to be in Code B decode mode, see 
+			/// setDecodeMode(). Call flush() to send the changed digits.
+			void setFixedPoint(const unsigned int & screenN, const int32_t & value, const uint8_t & decimals);
+			
+			/// \brief
+			/// Buffers an integer on given screen
+			/// \details
+			/// Same as setFixedPoint() without decimals.
+			void setNumber(const unsigned int & screenN, const int32_t & value);
+			
+			/// \brief
+			/// Sends all buffered digits that differ from the chips
+			/// \details
+			/// Loops through the 8 digit registers. A digit that is dirty on
+			/// at least one screen costs one frame, in which the dirty screens
+			/// get their buffered value and all others a no-op. Digits that
+			/// are clean on every screen, or beyond every screen's scan limit,
+			/// are skipped entirely. A dirty digit beyond its screen's scan
+			/// limit stays dirty.
+			void flush();
+			
+			/// \brief
+			/// Outputs all register contents to cout
+			/// \details
+			/// Calls the printRegister() function for all ledMatrices
+			void printAllRegisters();
+			
+			/// \brief
+			/// Returns the buffered pixel at (x, y)
+			/// \details
+			/// x runs along the chain, 0 being bit 0 of screen 1 and n*8-1
+			/// bit 7 of screen n. y is the digit register minus 1 (0 - 7).
+			/// Pixels outside the set are off.
+			bool getPixel(const int & x, const int & y);
+			
+			/// \brief
+			/// Draws a sprite into the buffer at pixel (x, y)
+			/// \details
+			/// Coordinates are the same as getPixel(), the sprite's top-left
+			/// pixel lands on (x, y). Negative or too large coordinates are
+			/// clipped at the edges of the set.
+			///
+			/// Every sprite byte is shifted once into a 16 bit window and 
+			/// split over the two screens it covers, so any pixel offset 
+			/// costs a couple of byte operations per line.
+			///
+			/// Returns a collision mask: bit i is set if line i of the sprite
+			/// covered a pixel that was already on before the blit. Call 
+			/// flush() to send the result.
+			uint8_t blit(const sprite & image, const int & x, const int & y, const rasterOp & op = rasterOp::OR);
+			
+			/// \brief
+			/// Sets the collumn to data at given screen.
+			/// \details
+			/// If given collumn is a digit register within the scan limit of 
+			/// the screen, the sendCommandToScreen() method will be called. If
+			/// not, nothing happens.
+			/// 
+			/// If coordinates is set to true, the led on (collumn, data) will 
+			/// be set, (1,1) being the corner.
+			/// If coordinates is set to false, the data value as bits will be 
+			/// set.
+			void setLed(const unsigned int & screenN, const uint8_t & collumn, const uint8_t & data, const bool & coordinates = false);
+			
+			/// \brief
+			/// Sets the led at given screen, collumn and row to off.
+			/// \details 
+			/// The led on (collumn, data) will be set off, (1,1) being the
+			/// corner.
+			void resetLedAt(const unsigned int & screenN, const int & collumn, const int & row);
+			
+			/// \brief
+			/// Sets given letter from 8x8 font to screen
+			/// \details
+			/// Gets the image from the font at index [letter]. This image
+			/// contains each row of data. The colors will be evaluated against
+			/// hwlib::black. Rows beyond the scan limit are skipped.
+			void setLetter(const unsigned int & screenN, const char & letter);
+			
+			/// \brief
+			/// Sets a word spread over ledMatrices
+			/// \details
+			/// This function will trim the word to n, and display the letters
+			/// from n to 0. It uses the setletter function with a char from word.
+			void setWord(const char word[], const unsigned int & size);
+			
+			/// \brief 
+			/// Sets the first row of given screen to the corresponding bit
+			/// \details
+			/// It iterates from 0 to 7, building its data from the latchedvalue
+			/// of the matrix on screenN-1. The data from latchedvalue is |'ed
+			/// with the last bit of row >> i.
+			/// This means that the least significant bit will be sent to collumn 1,
+			/// while the most significant bit will be sent to collumn 8.
+			/// Collumns beyond the scan limit are skipped.
+			void setRow(const unsigned int screenN, const uint8_t & row);
+			
+			/// \brief
+			/// Cycles the leds stepsN times, with a delay of cycleDelayNs in ns
+			/// \details
+			/// the cycleStep() method will be called for each step, then wait
+			/// cycleDelayNs
+			void cycleSteps(const int & stepsN);
+			
+			/// \brief
+			/// Cycles the whole screen nce
+			/// \details
+			/// Cycles over n*8 steps using cycleStep() method, waiting cycleDelayNs every step
+			void cycleSet();
+	};
+}
+
+#endif // LEDMATRIXCHAIN_HPP
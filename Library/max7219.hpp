@@ -17,12 +17,11 @@
 #define MAX7219_HPP
 
 #include "ledMatrix.hpp"
+#include "ledMatrixChain.hpp"
 #include "ledMatrixSet.hpp"
+#include "sprite.hpp"
+#include "powerManager.hpp"
 #include "spiBusLed.hpp"
 #include "pin_out_invert.hpp"
 
-
-#include "ledMatrix.cpp"
-#include "spiBusLed.cpp"
-
 #endif //MAX7219_HPP
\ No newline at end of file
@@ -0,0 +1,278 @@
+// ==========================================================================
+//
+// File      : powerManager.hpp
+// Part of   : C++ max7219 ledMatrix library
+// Author    : Jens Bouman
+// Github    : https://github.com/JensBouman/max7219
+// Copyright : jens.bouman@student.hu.nl 2018
+//
+//
+//Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file Boost V1.0.txt or copy at 
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef POWERMANAGER_HPP
+#define POWERMANAGER_HPP
+#include "hwlib.hpp"
+#include "ledMatrix.hpp"
+#include "ledMatrixSet.hpp"
+
+namespace max7219{
+	/// \brief
+	/// Intensity and shutdown control for a whole ledMatrixSet
+	/// \details
+	/// Every change to the intensity or shutdown registers is sent to all
+	/// screens, or a selection of them, in a single frame with a value per
+	/// screen.
+	///
+	/// Fading and idle blanking are done in small steps by update(), which
+	/// should be called every tick of the main loop. Each fade step costs one
+	/// frame, no matter how long the chain is.
+	template<unsigned int n>
+	class powerManager {
+		private:
+			ledMatrixSet<n> & matrices;
+			uint8_t intensity[n];
+			uint8_t targetIntensity[n];
+			uint8_t onIntensity[n];
+			bool shutdown[n];
+			
+			uint_fast64_t fadeStepUs = 0;
+			uint_fast64_t lastFadeStepUs = 0;
+			uint_fast64_t idleTimeoutUs = 0; // 0 = never blank
+			uint_fast64_t lastActivityUs = 0;
+			bool blanking = false; //fading out towards shutdown
+			
+			/// \brief
+			/// Sends the current intensity of every screen in one frame
+			void sendIntensity(){
+				matrices.setRegisters(ledMatrix::ADDR_INTENSITY, intensity);
+			}
+			
+			/// \brief
+			/// Sends the shutdown register to all screens in one frame
+			void sendShutdown(const bool & on){
+				uint8_t data[n];
+				for(unsigned int i = 0; i < n; ++i){
+					data[i] = on ? ledMatrix::SHUTDOWN_ON : ledMatrix::SHUTDOWN_OFF;
+				}
+				matrices.setRegisters(ledMatrix::ADDR_SHUTDOWN, data);
+				for(unsigned int i = 0; i < n; ++i){
+					shutdown[i] = on;
+				}
+			}
+			
+			/// \brief
+			/// Moves every intensity one step towards its target
+			/// \details
+			/// Returns true if any intensity changed.
+			bool fadeStep(){
+				bool changed = false;
+				for(unsigned int i = 0; i < n; ++i){
+					if(intensity[i] < targetIntensity[i]){
+						++intensity[i];
+						changed = true;
+					}else if(intensity[i] > targetIntensity[i]){
+						--intensity[i];
+						changed = true;
+					}
+				}
+				return changed;
+			}
+			
+		public:
+			/// \brief
+			/// Constructs the powerManager for given ledMatrixSet
+			/// \details
+			/// Assumes the screens are at their resetRegisters() defaults:
+			/// maximum intensity and not shut down. Nothing is sent.
+			powerManager(ledMatrixSet<n> & matrices):
+				matrices(matrices)
+			{
+				for(unsigned int i = 0; i < n; ++i){
+					intensity[i] = ledMatrix::INTENSITY_MAX;
+					targetIntensity[i] = ledMatrix::INTENSITY_MAX;
+					onIntensity[i] = ledMatrix::INTENSITY_MAX;
+					shutdown[i] = false;
+				}
+				lastActivityUs = hwlib::now_us();
+			}
+			
+			/// \brief
+			/// Sets the intensity of all screens in one frame
+			/// \details
+			/// Values above ledMatrix::INTENSITY_MAX are clamped. Stops any
+			/// running fade.
+			void setIntensity(const uint8_t & value){
+				uint8_t values[n];
+				for(unsigned int i = 0; i < n; ++i){
+					values[i] = value;
+				}
+				setIntensity(values);
+			}
+			
+			/// \brief
+			/// Sets the intensity per screen in one frame
+			/// \details
+			/// values[0] is screen 1. If selection is given, only screens for
+			/// which it is true are changed.
+			void setIntensity(const uint8_t values[n], const bool selection[n] = nullptr){
+				for(unsigned int i = 0; i < n; ++i){
+					if(selection == nullptr || selection[i]){
+						intensity[i] = values[i] > ledMatrix::INTENSITY_MAX ? ledMatrix::INTENSITY_MAX : values[i];
+						onIntensity[i] = intensity[i];
+					}
+					targetIntensity[i] = intensity[i];
+				}
+				matrices.setRegisters(ledMatrix::ADDR_INTENSITY, intensity, selection);
+			}
+			
+			/// \brief
+			/// Returns the current intensity of given screen
+			uint8_t getIntensity(const unsigned int & screenN){
+				return (screenN >= 1 && screenN <= n) ? intensity[screenN-1] : 0x00;
+			}
+			
+			/// \brief
+			/// Shuts all screens down, or wakes them up, in one frame
+			void setShutdown(const bool & on){
+				blanking = false;
+				sendShutdown(on);
+			}
+			
+			/// \brief
+			/// Shuts down or wakes up screens individually in one frame
+			/// \details
+			/// on[0] is screen 1. If selection is given, only screens for 
+			/// which it is true are changed. Like setShutdown(bool), this
+			/// stops a running idle fade-out.
+			void setShutdown(const bool on[n], const bool selection[n] = nullptr){
+				blanking = false;
+				uint8_t data[n];
+				for(unsigned int i = 0; i < n; ++i){
+					data[i] = on[i] ? ledMatrix::SHUTDOWN_ON : ledMatrix::SHUTDOWN_OFF;
+					if(selection == nullptr || selection[i]){
+						shutdown[i] = on[i];
+					}
+				}
+				matrices.setRegisters(ledMatrix::ADDR_SHUTDOWN, data, selection);
+			}
+			
+			/// \brief
+			/// Returns true if every screen was shut down by this class
+			bool isShutdown(){
+				for(unsigned int i = 0; i < n; ++i){
+					if(!shutdown[i]){
+						return false;
+					}
+				}
+				return true;
+			}
+			
+			/// \brief
+			/// Returns true if given screen was shut down by this class
+			bool isShutdown(const unsigned int & screenN){
+				return screenN >= 1 && screenN <= n && shutdown[screenN-1];
+			}
+			
+			/// \brief
+			/// Fades all screens towards given intensity
+			/// \details
+			/// update() moves the intensity one step every stepUs 
+			/// microseconds.
+			void fadeTo(const uint8_t & target, const uint_fast64_t & stepUs){
+				uint8_t targets[n];
+				for(unsigned int i = 0; i < n; ++i){
+					targets[i] = target;
+				}
+				fadeTo(targets, stepUs);
+			}
+			
+			/// \brief
+			/// Fades every screen towards its own intensity
+			/// \details
+			/// targets[0] is screen 1. Values above ledMatrix::INTENSITY_MAX
+			/// are clamped.
+			void fadeTo(const uint8_t targets[n], const uint_fast64_t & stepUs){
+				for(unsigned int i = 0; i < n; ++i){
+					targetIntensity[i] = targets[i] > ledMatrix::INTENSITY_MAX ? ledMatrix::INTENSITY_MAX : targets[i];
+					onIntensity[i] = targetIntensity[i];
+				}
+				fadeStepUs = stepUs;
+				lastFadeStepUs = hwlib::now_us();
+				blanking = false;
+			}
+			
+			/// \brief
+			/// Returns true while a fade has not reached its target
+			bool isFading(){
+				for(unsigned int i = 0; i < n; ++i){
+					if(intensity[i] != targetIntensity[i]){
+						return true;
+					}
+				}
+				return false;
+			}
+			
+			/// \brief
+			/// Sets the time without activity after which the screens fade out
+			/// and shut down
+			/// \details
+			/// A timeout of 0 disables idle blanking. stepUs is the time per
+			/// intensity step of the fade-out and fade-in.
+			void setIdleTimeout(const uint_fast64_t & timeoutUs, const uint_fast64_t & stepUs){
+				idleTimeoutUs = timeoutUs;
+				fadeStepUs = stepUs;
+				lastActivityUs = hwlib::now_us();
+			}
+			
+			/// \brief
+			/// Registers user activity
+			/// \details
+			/// Restarts the idle timer. If the screens were blanked, they are
+			/// woken up and fade back in to their previous intensity.
+			void touch(){
+				lastActivityUs = hwlib::now_us();
+				if(isShutdown() || blanking){
+					blanking = false;
+					if(isShutdown()){
+						sendShutdown(false);
+					}
+					for(unsigned int i = 0; i < n; ++i){
+						targetIntensity[i] = onIntensity[i];
+					}
+					lastFadeStepUs = lastActivityUs;
+				}
+			}
+			
+			/// \brief
+			/// Advances fades and idle blanking, call every tick
+			/// \details
+			/// Sends at most one intensity frame per call. When the idle 
+			/// timeout has passed the screens fade to the minimum intensity
+			/// and are shut down once it is reached.
+			void update(){
+				uint_fast64_t now = hwlib::now_us();
+				if(idleTimeoutUs > 0 && !isShutdown() && !blanking && now - lastActivityUs >= idleTimeoutUs){
+					blanking = true;
+					for(unsigned int i = 0; i < n; ++i){
+						targetIntensity[i] = ledMatrix::INTENSITY_MIN;
+					}
+					lastFadeStepUs = now;
+				}
+				if(now - lastFadeStepUs >= fadeStepUs){
+					lastFadeStepUs = now;
+					if(fadeStep()){
+						sendIntensity();
+					}else if(blanking){
+						blanking = false;
+						sendShutdown(true);
+					}
+				}
+			}
+	};
+}
+
+#endif // POWERMANAGER_HPP
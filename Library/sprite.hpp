@@ -0,0 +1,44 @@
+// ==========================================================================
+//
+// File      : sprite.hpp
+// Part of   : C++ max7219 ledMatrix library
+// Author    : Jens Bouman
+// Github    : https://github.com/JensBouman/max7219
+// Copyright : jens.bouman@student.hu.nl 2018
+//
+//
+//Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file Boost V1.0.txt or copy at 
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef SPRITE_HPP
+#define SPRITE_HPP
+#include "hwlib.hpp"
+
+namespace max7219{
+	/// \brief
+	/// Small 1-bit bitmap that can be blitted onto a ledMatrixSet
+	/// \details
+	/// The bitmap is stored in the same packing as the digit registers: 
+	/// every line is one or more bytes of which bit 0 is the leftmost pixel
+	/// (closest to screen 1). A line takes (width + 7) / 8 bytes, lines are
+	/// stored one after another. A sprite is at most 8 lines high, the height
+	/// of a screen.
+	struct sprite {
+		const uint8_t * lines;
+		uint8_t width;
+		uint8_t height;
+	};
+	
+	/// \brief
+	/// How sprite pixels are combined with the pixels already on screen
+	/// \details
+	/// COPY replaces every pixel under the sprite, OR only sets pixels, AND
+	/// clears the pixels under the sprite that are not set in the sprite and
+	/// XOR toggles the pixels that are set in the sprite.
+	enum class rasterOp { COPY, OR, AND, XOR };
+}
+
+#endif // SPRITE_HPP
@@ -0,0 +1,128 @@
+// Benchmark of the orientation filter
+//
+// Feeds a recorded trace, or a synthetic one when no file is given, to the
+// orientationFilter and reports the time per update and the error against the
+// reference angles. After that the MPU6050 burst and FIFO reads are run
+// against mpuReplayBus, reporting bus transactions and bytes per sample.
+//
+// The trace file has the format of loadMpuTrace() in Tests/MPU6050, so the
+// same recording can be replayed on mpuReplayBus.
+
+#include "orientation.hpp"
+#include "MPU6050.hpp"
+#include "mpuReplayBus.hpp"
+#include "mpuTrace.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Slow tilt in both axes at 1 kHz with a gyro bias and a bit of accelerometer
+// noise, like the board being steered in the demo game.
+static void syntheticTrace(std::vector<mpuTraceLine> & trace){
+	const double pi = 3.14159265358979;
+	uint32_t noise = 12345;
+	for(int i = 0; i < 20000; i++){
+		double t = i / 1000.0;
+		double pitch = 30.0 * std::sin(2 * pi * 0.5 * t);
+		double roll = 45.0 * std::sin(2 * pi * 0.3 * t);
+		double pitchRate = 30.0 * 2 * pi * 0.5 * std::cos(2 * pi * 0.5 * t);
+		double rollRate = 45.0 * 2 * pi * 0.3 * std::cos(2 * pi * 0.3 * t);
+		double p = pitch * pi / 180;
+		double r = roll * pi / 180;
+		noise = noise * 1103515245 + 12345;
+		int32_t jitter = int32_t((noise >> 16) % 41) - 20;
+		mpuTraceLine line = {};
+		line.sample.timestamp = uint_fast64_t(i) * 1000;
+		line.sample.accelX = int32_t(-1000 * std::sin(p)) + jitter;
+		line.sample.accelY = int32_t(1000 * std::cos(p) * std::sin(r)) - jitter;
+		line.sample.accelZ = int32_t(1000 * std::cos(p) * std::cos(r));
+		line.sample.gyroX = int32_t(rollRate * 1000) + 500;
+		line.sample.gyroY = int32_t(pitchRate * 1000) - 500;
+		line.pitch = int32_t(pitch * 1000);
+		line.roll = int32_t(roll * 1000);
+		trace.push_back(line);
+	}
+}
+
+int main(int argc, char ** argv){
+	std::vector<mpuTraceLine> trace;
+	if(argc > 1){
+		if(!loadMpuTrace(argv[1], trace)){
+			printf("Can't open %s\n", argv[1]);
+			return 1;
+		}
+	}else{
+		syntheticTrace(trace);
+	}
+	if(trace.empty()){
+		printf("Empty trace\n");
+		return 1;
+	}
+	
+	orientationFilter filter;
+	double sumSquares = 0;
+	int32_t maxError = 0;
+	// Skip the first second, while the filter settles
+	unsigned int settle = 0;
+	while(settle < trace.size() && trace[settle].sample.timestamp - trace[0].sample.timestamp < 1000000){
+		settle++;
+	}
+	unsigned int counted = 0;
+	for(unsigned int i = 0; i < trace.size(); i++){
+		filter.update(trace[i].sample);
+		if(i >= settle){
+			int32_t errors[2] = {filter.getPitch() - trace[i].pitch, filter.getRoll() - trace[i].roll};
+			for(int32_t error : errors){
+				sumSquares += double(error) * error;
+				maxError = std::abs(error) > maxError ? std::abs(error) : maxError;
+			}
+			counted++;
+		}
+	}
+	
+	const int rounds = 50;
+	volatile int32_t sink = 0;
+	auto start = std::chrono::steady_clock::now();
+	for(int round = 0; round < rounds; round++){
+		filter.reset();
+		for(const mpuTraceLine & line : trace){
+			filter.update(line.sample);
+		}
+		sink = sink + filter.getRoll();
+	}
+	auto stop = std::chrono::steady_clock::now();
+	double nsPerUpdate = std::chrono::duration<double, std::nano>(stop - start).count() / (double(rounds) * trace.size());
+	
+	printf("samples       : %u\n", (unsigned int)trace.size());
+	printf("ns per update : %.1f\n", nsPerUpdate);
+	if(counted > 0){
+		printf("rms error     : %.3f deg\n", std::sqrt(sumSquares / (2.0 * counted)) / 1000);
+		printf("max error     : %.3f deg\n", maxError / 1000.0);
+	}
+	
+	mpuReplayBus bus;
+	bus.setSynthetic(30, 400, 4);
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	const unsigned int samples = 1000;
+	
+	bus.resetCounters();
+	for(unsigned int i = 0; i < samples; i++){
+		bus.advance();
+		mpu.setAccelGyro();
+	}
+	printf("burst read    : %.2f transactions, %.1f bytes per sample\n", double(bus.getTransactions()) / samples, double(bus.getBytes()) / samples);
+	
+	mpu.enableFifo(MPU6050::FIFO_ACCEL | MPU6050::FIFO_GYRO, 0);
+	bus.resetCounters();
+	unsigned int drained = 0;
+	for(unsigned int i = 0; i < samples; i += 20){
+		bus.advance(20);
+		drained += mpu.drainFifo();
+		mpuSample sample;
+		while(mpu.getFifoSamples().pop(sample)){}
+	}
+	printf("FIFO drain    : %.2f transactions, %.1f bytes per sample\n", double(bus.getTransactions()) / drained, double(bus.getBytes()) / drained);
+	return 0;
+}
@@ -3,12 +3,28 @@
 
 #define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
 #include "catch.hpp"
+#include <type_traits>
 //This file will be used for the functional tests of the system, not the leds themself.
 //This will only guarantee that the system is functioning, not necessarily that 
 //the leds are working as intended. For that purpose, refere to the physical tests.
 
+//Counts the rising edges on the chipselect line, every rising edge is one frame
+class frameCounter : public hwlib::pin_out{
+	public:
+		unsigned int frames = 0;
+		void set(bool x, hwlib::buffering buf = hwlib::buffering::unbuffered) override {
+			if(x){
+				++frames;
+			}
+		}
+};
+
 
 /* ------------- ledMatrixSet tests ------- */
+//A copy would refer to the ledMatrices of the original
+static_assert(!std::is_copy_constructible<max7219::ledMatrixSet<4>>::value, "ledMatrixSet can't be copied");
+static_assert(!std::is_copy_assignable<max7219::ledMatrixSet<4>>::value, "ledMatrixSet can't be assigned");
+
 TEST_CASE( "constructor, no parameters; registers" ){
 	//testing after initialization that the registers are still 0. they will be set after resetregisters
 	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
@@ -96,6 +112,286 @@ TEST_CASE("resetRegisters, different registers"){
 	REQUIRE(matrices.getLedMatrix(1).getLatchedValue(0x0C) == 0x0C01);
 }
 
+TEST_CASE("decode mode, set and restored by resetRegisters"){
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<4> matrices(spi_bus);
+	matrices.setDecodeMode(2, max7219::ledMatrix::DECODE_ALL);
+	REQUIRE(matrices.getLedMatrix(2).getLatchedValue(max7219::ledMatrix::ADDR_DECODE) == 0x09FF);
+	REQUIRE(matrices.getLedMatrix(1).getLatchedValue(max7219::ledMatrix::ADDR_DECODE) == 0x0900);
+	matrices.resetRegisters();
+	REQUIRE(matrices.getLedMatrix(2).getLatchedValue(max7219::ledMatrix::ADDR_DECODE) == 0x09FF);
+	REQUIRE(matrices.getLedMatrix(3).getLatchedValue(max7219::ledMatrix::ADDR_DECODE) == 0x0900);
+}
+
+TEST_CASE("setNumber, digits and blanking"){
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<4> matrices(spi_bus);
+	matrices.setNumber(1, -42);
+	matrices.flush();
+	REQUIRE(matrices.getLedMatrix(1).getLatchedValue(1) == 0x0102);
+	REQUIRE(matrices.getLedMatrix(1).getLatchedValue(2) == 0x0204);
+	REQUIRE(matrices.getLedMatrix(1).getLatchedValue(3) == 0x030A);
+	REQUIRE(matrices.getLedMatrix(1).getLatchedValue(4) == 0x040F);
+	REQUIRE(matrices.getLedMatrix(2).getLatchedValue(1) == 0x0000);
+}
+
+TEST_CASE("setFixedPoint, decimal point and leading zero"){
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<4> matrices(spi_bus);
+	matrices.setFixedPoint(3, 5, 2);
+	REQUIRE(matrices.getLedMatrix(3).getBufferedValue(1) == 0x05);
+	REQUIRE(matrices.getLedMatrix(3).getBufferedValue(2) == 0x00);
+	REQUIRE(matrices.getLedMatrix(3).getBufferedValue(3) == 0x80);
+	REQUIRE(matrices.getLedMatrix(3).getBufferedValue(4) == 0x0F);
+}
+
+TEST_CASE("setNumber, overflow shows dashes"){
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<4> matrices(spi_bus);
+	matrices.setNumber(1, 123456789);
+	REQUIRE(matrices.getLedMatrix(1).getBufferedValue(1) == 0x0A);
+	REQUIRE(matrices.getLedMatrix(1).getBufferedValue(8) == 0x0A);
+}
+
+TEST_CASE("setFixedPoint, too many decimals show dashes"){
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<2> matrices(spi_bus);
+	matrices.setFixedPoint(1, 5, 8);
+	matrices.setFixedPoint(2, 5, 200);
+	for(uint8_t digit = 1; digit <= 8; digit++){
+		REQUIRE(matrices.getLedMatrix(1).getBufferedValue(digit) == 0x0A);
+		REQUIRE(matrices.getLedMatrix(2).getBufferedValue(digit) == 0x0A);
+	}
+	
+	// the most decimals that fit
+	matrices.setFixedPoint(1, 5, 7);
+	REQUIRE(matrices.getLedMatrix(1).getBufferedValue(1) == 0x05);
+	REQUIRE(matrices.getLedMatrix(1).getBufferedValue(7) == 0x00);
+	REQUIRE(matrices.getLedMatrix(1).getBufferedValue(8) == 0x80);
+}
+
+TEST_CASE("flush, only changed digits are sent"){
+	frameCounter cs;
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, cs, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<4> matrices(spi_bus);
+	matrices.setNumber(1, 1234);
+	matrices.flush();
+	REQUIRE(matrices.getLedMatrix(1).getDirtyDigits() == 0x00);
+	cs.frames = 0;
+	matrices.setNumber(1, 1235);
+	matrices.flush();
+	REQUIRE(cs.frames == 1);
+	cs.frames = 0;
+	matrices.setNumber(1, 1235);
+	matrices.flush();
+	REQUIRE(cs.frames == 0);
+}
+
+TEST_CASE("scan limit, restored by resetRegisters"){
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<4> matrices(spi_bus);
+	matrices.resetRegisters();
+	REQUIRE(matrices.getLedMatrix(4).getLatchedValue(max7219::ledMatrix::ADDR_SCAN_LIMIT) == 0x0B07);
+	matrices.setScanLimit(4, 3);
+	matrices.resetRegisters();
+	REQUIRE(matrices.getLedMatrix(4).getLatchedValue(max7219::ledMatrix::ADDR_SCAN_LIMIT) == 0x0B03);
+	REQUIRE(matrices.getLedMatrix(3).getLatchedValue(max7219::ledMatrix::ADDR_SCAN_LIMIT) == 0x0B07);
+}
+
+TEST_CASE("scan limit, writes beyond the limit are kept until it is raised"){
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<4> matrices(spi_bus);
+	matrices.setScanLimit(2, 1);
+	matrices.setDigit(2, 3, 0x7F);
+	matrices.setLed(2, 4, 0xFF);
+	REQUIRE(matrices.getLedMatrix(2).getDirtyDigits() == 0x04);
+	REQUIRE(matrices.getLedMatrix(2).getBufferedValue(3) == 0x7F);
+	REQUIRE(matrices.getLedMatrix(2).getLatchedValue(4) == 0x0000);
+	matrices.flush();
+	REQUIRE(matrices.getLedMatrix(2).getLatchedValue(3) == 0x0000);
+	REQUIRE(matrices.getLedMatrix(2).getDirtyDigits() == 0x04);
+	matrices.setScanLimit(2, max7219::ledMatrix::SCAN_LIMIT_ALL);
+	matrices.flush();
+	REQUIRE(matrices.getLedMatrix(2).getLatchedValue(3) == 0x037F);
+	REQUIRE(matrices.getLedMatrix(2).getDirtyDigits() == 0x00);
+}
+
+TEST_CASE("scan limit, flush skips dead digits"){
+	frameCounter cs;
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, cs, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<2> matrices(spi_bus);
+	matrices.setNumber(1, 12345678);
+	matrices.setNumber(2, 12345678);
+	matrices.setScanLimit(1, 2);
+	matrices.setScanLimit(2, 3);
+	cs.frames = 0;
+	matrices.flush();
+	REQUIRE(cs.frames == 4);
+}
+
+TEST_CASE("fitScanLimits, limit follows content"){
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<2> matrices(spi_bus);
+	matrices.setDigit(1, 5, 0x81);
+	matrices.setDecodeMode(2, max7219::ledMatrix::DECODE_ALL);
+	matrices.setNumber(2, 42);
+	matrices.flush();
+	matrices.fitScanLimits();
+	REQUIRE(matrices.getLedMatrix(1).getLatchedValue(max7219::ledMatrix::ADDR_SCAN_LIMIT) == 0x0B04);
+	REQUIRE(matrices.getLedMatrix(2).getLatchedValue(max7219::ledMatrix::ADDR_SCAN_LIMIT) == 0x0B01);
+	
+	// content drawn beyond the fitted limit grows it again
+	matrices.setDigit(1, 7, 0x18);
+	matrices.fitScanLimits();
+	REQUIRE(matrices.getLedMatrix(1).getLatchedValue(max7219::ledMatrix::ADDR_SCAN_LIMIT) == 0x0B06);
+	REQUIRE(matrices.getLedMatrix(1).getLatchedValue(7) == 0x0718);
+}
+
+TEST_CASE("fitScanLimits, a lit decimal point is content"){
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<1> matrices(spi_bus);
+	matrices.setDecodeMode(1, max7219::ledMatrix::DECODE_ALL);
+	for(uint8_t digit = 1; digit <= 8; digit++){
+		matrices.setDigit(1, digit, max7219::ledMatrix::CODE_B_BLANK);
+	}
+	matrices.setDigit(1, 1, 0x01);
+	matrices.setDigit(1, 4, max7219::ledMatrix::CODE_B_BLANK, true);
+	matrices.flush();
+	matrices.fitScanLimits();
+	REQUIRE(matrices.getLedMatrix(1).getLatchedValue(max7219::ledMatrix::ADDR_SCAN_LIMIT) == 0x0B03);
+	
+	matrices.setDigit(1, 4, max7219::ledMatrix::CODE_B_BLANK);
+	matrices.fitScanLimits();
+	REQUIRE(matrices.getLedMatrix(1).getLatchedValue(max7219::ledMatrix::ADDR_SCAN_LIMIT) == 0x0B00);
+}
+
+TEST_CASE("setRegisters, per screen values in one frame"){
+	frameCounter cs;
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, cs, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<4> matrices(spi_bus);
+	uint8_t data[4] = {1, 2, 3, 4};
+	bool selection[4] = {true, false, true, true};
+	matrices.setRegisters(max7219::ledMatrix::ADDR_INTENSITY, data, selection);
+	REQUIRE(cs.frames == 1);
+	REQUIRE(matrices.getLedMatrix(1).getLatchedValue(max7219::ledMatrix::ADDR_INTENSITY) == 0x0A01);
+	REQUIRE(matrices.getLedMatrix(2).getLatchedValue(max7219::ledMatrix::ADDR_INTENSITY) == 0x0000);
+	REQUIRE(matrices.getLedMatrix(4).getLatchedValue(max7219::ledMatrix::ADDR_INTENSITY) == 0x0A04);
+}
+TEST_CASE("blit, offset across screen boundary"){
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<4> matrices(spi_bus);
+	const uint8_t lines[] = {0x0F, 0x09};
+	max7219::sprite block = {lines, 4, 2};
+	REQUIRE(matrices.blit(block, 6, 2) == 0x00);
+	REQUIRE(matrices.getLedMatrix(1).getBufferedValue(3) == 0xC0);
+	REQUIRE(matrices.getLedMatrix(2).getBufferedValue(3) == 0x03);
+	REQUIRE(matrices.getLedMatrix(1).getBufferedValue(4) == 0x40);
+	REQUIRE(matrices.getLedMatrix(2).getBufferedValue(4) == 0x02);
+	REQUIRE(matrices.getPixel(9, 3) == true);
+	REQUIRE(matrices.getPixel(8, 3) == false);
+}
+
+TEST_CASE("blit, clipping at the edges"){
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<2> matrices(spi_bus);
+	const uint8_t lines[] = {0xFF, 0xFF};
+	max7219::sprite bar = {lines, 8, 2};
+	matrices.blit(bar, -3, -1);
+	REQUIRE(matrices.getLedMatrix(1).getBufferedValue(1) == 0x1F);
+	REQUIRE(matrices.getLedMatrix(1).getBufferedValue(2) == 0x00);
+	matrices.blit(bar, 13, 7);
+	REQUIRE(matrices.getLedMatrix(2).getBufferedValue(8) == 0xE0);
+}
+
+TEST_CASE("blit, raster operations and collision"){
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<2> matrices(spi_bus);
+	const uint8_t full[] = {0x0F};
+	const uint8_t dots[] = {0x05};
+	max7219::sprite fullSprite = {full, 4, 1};
+	max7219::sprite dotSprite = {dots, 4, 1};
+	matrices.blit(fullSprite, 0, 0);
+	REQUIRE(matrices.blit(dotSprite, 0, 0, max7219::rasterOp::XOR) == 0x01);
+	REQUIRE(matrices.getLedMatrix(1).getBufferedValue(1) == 0x0A);
+	matrices.blit(fullSprite, 2, 0, max7219::rasterOp::OR);
+	REQUIRE(matrices.getLedMatrix(1).getBufferedValue(1) == 0x3E);
+	matrices.blit(dotSprite, 2, 0, max7219::rasterOp::AND);
+	REQUIRE(matrices.getLedMatrix(1).getBufferedValue(1) == 0x16);
+	REQUIRE(matrices.blit(dotSprite, 8, 0, max7219::rasterOp::COPY) == 0x00);
+	REQUIRE(matrices.getLedMatrix(2).getBufferedValue(1) == 0x05);
+}
+
+/* ------------- powerManager tests ------- */
+TEST_CASE("powerManager, fade one step per update"){
+	frameCounter cs;
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, cs, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<4> matrices(spi_bus);
+	max7219::powerManager<4> power(matrices);
+	power.fadeTo(0x0D, 0);
+	power.update();
+	REQUIRE(power.getIntensity(1) == 0x0E);
+	REQUIRE(cs.frames == 1);
+	power.update();
+	power.update();
+	REQUIRE(power.getIntensity(4) == 0x0D);
+	REQUIRE(power.isFading() == false);
+	REQUIRE(matrices.getLedMatrix(4).getLatchedValue(max7219::ledMatrix::ADDR_INTENSITY) == 0x0A0D);
+	REQUIRE(cs.frames == 2);
+}
+
+TEST_CASE("powerManager, idle blanking and wake up"){
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<2> matrices(spi_bus);
+	max7219::powerManager<2> power(matrices);
+	power.setIntensity(0x02);
+	power.setIdleTimeout(1, 0);
+	for(int i = 0; i < 1000000 && !power.isShutdown(); ++i){
+		power.update();
+	}
+	REQUIRE(power.isShutdown());
+	REQUIRE(matrices.getLedMatrix(2).getLatchedValue(max7219::ledMatrix::ADDR_SHUTDOWN) == 0x0C00);
+	power.setIdleTimeout(0, 0);
+	power.touch();
+	REQUIRE(power.isShutdown() == false);
+	power.update();
+	power.update();
+	REQUIRE(power.getIntensity(1) == 0x02);
+}
+
+
+TEST_CASE("powerManager, shutdown per screen"){
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<2> matrices(spi_bus);
+	max7219::powerManager<2> power(matrices);
+	const bool off[] = {true, true};
+	const bool first[] = {true, false};
+	const bool on[] = {false, false};
+	power.setShutdown(off, first);
+	REQUIRE(power.isShutdown(1));
+	REQUIRE_FALSE(power.isShutdown(2));
+	REQUIRE_FALSE(power.isShutdown());
+	power.setShutdown(off);
+	REQUIRE(power.isShutdown());
+	power.setShutdown(on, first);
+	REQUIRE_FALSE(power.isShutdown(1));
+	REQUIRE(power.isShutdown(2));
+	REQUIRE_FALSE(power.isShutdown());
+	
+	//an idle fade-out is stopped, like by setShutdown(bool)
+	power.setShutdown(false);
+	power.setIdleTimeout(1, 0);
+	for(int i = 0; i < 1000000 && !power.isFading(); ++i){
+		power.update();
+	}
+	REQUIRE(power.isFading());
+	power.setShutdown(on);
+	power.setIdleTimeout(0, 0);
+	for(int i = 0; i < 100; ++i){
+		power.update();
+	}
+	REQUIRE_FALSE(power.isShutdown(1));
+	REQUIRE_FALSE(power.isShutdown(2));
+}
 
 /* ------------- ledMatrix tests ------- */
 TEST_CASE("ledMatrix, constructor"){
@@ -126,6 +422,18 @@ TEST_CASE("ledMatrix latch register, get out of bounds"){
 	REQUIRE(led.getLatchedValue(0x88) == 0x00);
 }
 
+TEST_CASE("ledMatrix buffered value, dirty only when changed"){
+	max7219::ledMatrix led;
+	led.setBufferedValue(3, 0x00);
+	REQUIRE(led.getDirtyDigits() == 0x00);
+	led.setBufferedValue(3, 0x12);
+	REQUIRE(led.getDirtyDigits() == 0x04);
+	REQUIRE(led.getBufferedValue(3) == 0x12);
+	led.setTempValue(0x0312);
+	led.latchRegister();
+	REQUIRE(led.getDirtyDigits() == 0x00);
+}
+
 
 /* ------------- spiBusLed tests ------- */
 TEST_CASE("makeDataArray, general testing"){
@@ -0,0 +1,461 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
+#include "catch.hpp"
+
+// MPU6050.hpp defines byte as a macro, so it goes after catch.hpp
+#include "hwlib.hpp"
+#include "MPU6050.hpp"
+#include "mpuCalibrator.hpp"
+#include "mpuDataReady.hpp"
+#include "orientation.hpp"
+#include "mpuReplayBus.hpp"
+#include <string>
+//Tests of the MPU6050 driver and what is built on it, against mpuReplayBus,
+//a simulated MPU6050. The transaction counts keep the bus traffic per call
+//from growing unnoticed.
+
+
+/* ------------- register file ------- */
+TEST_CASE("replay bus, who am i and wake up"){
+	mpuReplayBus bus;
+	MPU6050 mpu(bus);
+	REQUIRE(mpu.whoAmI() == 0x68);
+	REQUIRE(bus.getRegister(mpuReplayBus::REG_PWR_MGMT_1) == 0x40);
+	mpu.wakeUp();
+	REQUIRE(bus.getRegister(mpuReplayBus::REG_PWR_MGMT_1) == 0x00);
+	REQUIRE(bus.getWrongAddress() == 0);
+}
+
+TEST_CASE("replay bus, no samples while asleep"){
+	mpuReplayBus bus;
+	bus.setSynthetic(0, 100);
+	bus.advance(5);
+	REQUIRE(bus.getRegister(mpuReplayBus::REG_INT_STATUS) == 0x00);
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	bus.advance();
+	REQUIRE(bus.getRegister(mpuReplayBus::REG_INT_STATUS) == 0x01);
+}
+
+TEST_CASE("configure, one burst and cached getters"){
+	mpuReplayBus bus;
+	MPU6050 mpu(bus);
+	mpuConfig config;
+	config.clock = mpuClock::PLL_XGYRO;
+	config.dlpf = mpuDlpf::BW_44HZ;
+	config.sampleRateDivider = 9;
+	config.gyroRange = mpuGyroRange::DPS_1000;
+	config.accelRange = mpuAccelRange::G_8;
+	mpu.configure(config);
+	REQUIRE(bus.getWrites() == 2);
+	REQUIRE(bus.getRegister(0x19) == 9);
+	REQUIRE(bus.getRegister(0x1A) == 3);
+	REQUIRE(bus.getRegister(0x1B) == (2 << 3));
+	REQUIRE(bus.getRegister(0x1C) == (2 << 3));
+	REQUIRE(bus.getRegister(mpuReplayBus::REG_PWR_MGMT_1) == 0x01);
+	REQUIRE(bus.getSampleRateHz() == 100);
+	
+	bus.resetCounters();
+	REQUIRE(mpu.getFullScaleGyroRange() == 2);
+	REQUIRE(mpu.getFullScaleAccelRange() == 2);
+	REQUIRE(mpu.getSampleRateHz() == 100);
+	REQUIRE(bus.getTransactions() == 0);
+}
+
+//Path of a file next to this test
+static std::string fixture(const char * name){
+	std::string path = __FILE__;
+	size_t slash = path.find_last_of("/\\");
+	return (slash == std::string::npos ? std::string() : path.substr(0, slash + 1)) + name;
+}
+
+TEST_CASE("replay bus, samples from a trace file"){
+	mpuReplayBus bus;
+	REQUIRE_FALSE(bus.loadTrace(fixture("missing.csv").c_str()));
+	REQUIRE(bus.loadTrace(fixture("trace.csv").c_str(), false));
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	
+	bus.advance();
+	mpu.setAccelGyro();
+	REQUIRE(mpu.getAccelX() == 0);
+	REQUIRE(mpu.getAccelZ() == 16384);
+	
+	bus.advance();
+	mpu.setAccelGyro();
+	REQUIRE(mpu.getAccelX() == 8192);
+	REQUIRE(mpu.getAccelY() == -4096);
+	REQUIRE(mpu.getGyroX() == 131);
+	REQUIRE(mpu.getGyroY() == -262);
+	
+	// converted at the range set now, the last sample repeats
+	mpuConfig config;
+	config.accelRange = mpuAccelRange::G_8;
+	config.gyroRange = mpuGyroRange::DPS_1000;
+	mpu.configure(config);
+	bus.advance(2);
+	mpu.setAccelGyro();
+	REQUIRE(mpu.getAccelX() == -4096);
+	REQUIRE(mpu.getGyroZ() == 8188);
+}
+
+/* ------------- burst reads ------- */
+TEST_CASE("setAccelGyro, one burst of 14 bytes"){
+	mpuReplayBus bus;
+	bus.setTrace({mpuSample{0, 100, -200, 16384, -521, 5, -6, 7}});
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	bus.advance();
+	bus.resetCounters();
+	mpu.setAccelGyro();
+	REQUIRE(bus.getTransactions() == 2);
+	REQUIRE(bus.getBytes() == 15);
+	REQUIRE(mpu.getAccelX() == 100);
+	REQUIRE(mpu.getAccelY() == -200);
+	REQUIRE(mpu.getAccelZ() == 16384);
+	REQUIRE(mpu.getTempInCelcius() == 35);
+	REQUIRE(mpu.getGyroX() == 5);
+	REQUIRE(mpu.getGyroY() == -6);
+	REQUIRE(mpu.getGyroZ() == 7);
+}
+
+TEST_CASE("getScaledSample, milli-g and calibration"){
+	mpuReplayBus bus;
+	bus.setTrace({mpuSample{0, 8192, 0, 16384 + 100, 0, 131 + 20, 0, 0}});
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	bus.advance();
+	mpu.setCalibration(mpuCalibration{0, 0, 100, 20, 0, 0});
+	mpu.setAccelGyro();
+	mpuScaledSample scaled;
+	mpu.getScaledSample(scaled);
+	REQUIRE(scaled.accelX == 500);
+	REQUIRE(scaled.accelZ == 1000);
+	REQUIRE(scaled.gyroX == 1000);
+}
+
+/* ------------- FIFO ------- */
+TEST_CASE("drainFifo, samples in order and bursts of 16"){
+	std::vector<mpuSample> trace;
+	for(int16_t i = 0; i < 40; i++){
+		trace.push_back(mpuSample{0, i, 0, 0, 0, int16_t(-i), 0, 0});
+	}
+	mpuReplayBus bus;
+	bus.setTrace(trace);
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	mpu.enableFifo(MPU6050::FIFO_ACCEL | MPU6050::FIFO_GYRO, 0);
+	bus.advance(20);
+	REQUIRE(bus.getFifoSize() == 20 * 12);
+	bus.resetCounters();
+	REQUIRE(mpu.drainFifo() == 20);
+	// INT_STATUS, FIFO count and two bursts, a write and a read each
+	REQUIRE(bus.getTransactions() == 8);
+	REQUIRE(bus.getFifoSize() == 0);
+	mpuSample sample;
+	for(int16_t i = 0; i < 20; i++){
+		REQUIRE(mpu.getFifoSamples().pop(sample));
+		REQUIRE(sample.accelX == i);
+		REQUIRE(sample.gyroX == -i);
+	}
+	REQUIRE_FALSE(mpu.getFifoSamples().pop(sample));
+}
+
+TEST_CASE("drainFifo, overflow resets the FIFO"){
+	mpuReplayBus bus;
+	bus.setSynthetic(10, 100);
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	mpu.enableFifo(MPU6050::FIFO_ACCEL | MPU6050::FIFO_GYRO, 0);
+	bus.advance(100);
+	REQUIRE(mpu.drainFifo() == 0);
+	REQUIRE(mpu.getFifoOverflows() == 1);
+	REQUIRE(bus.getFifoSize() == 0);
+	bus.advance(3);
+	REQUIRE(mpu.drainFifo() == 3);
+}
+
+/* ------------- data ready ------- */
+TEST_CASE("mpuDataReady, one burst per interrupt"){
+	mpuReplayBus bus;
+	bus.setTrace({mpuSample{0, 1, 2, 3, 0, 4, 5, 6}, mpuSample{0, 7, 8, 9, 0, 10, 11, 12}});
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	mpuDataReady sensor(mpu, hwlib::pin_in_dummy);
+	sensor.begin();
+	REQUIRE(bus.getRegister(mpuReplayBus::REG_INT_ENABLE) == MPU6050::INT_DATA_READY);
+	mpuSample sample;
+	REQUIRE(sensor.getLatest(sample) == 0);
+	
+	// no interrupt, no bus traffic
+	bus.advance();
+	bus.resetCounters();
+	REQUIRE_FALSE(sensor.update());
+	REQUIRE(bus.getTransactions() == 0);
+	
+	// INT_STATUS and one burst, a write and a read each
+	sensor.onInterrupt();
+	REQUIRE(sensor.update());
+	REQUIRE(bus.getTransactions() == 4);
+	REQUIRE(sensor.getLatest(sample) == 1);
+	REQUIRE(sample.accelX == 1);
+	REQUIRE(sample.gyroZ == 6);
+	
+	// an interrupt without a new sample publishes nothing
+	sensor.onInterrupt();
+	REQUIRE_FALSE(sensor.update());
+	REQUIRE(sensor.getLatest(sample) == 1);
+	
+	bus.advance();
+	sensor.onInterrupt();
+	REQUIRE(sensor.update());
+	REQUIRE(sensor.getLatest(sample) == 2);
+	REQUIRE(sample.accelX == 7);
+}
+
+TEST_CASE("mpuDataReady, FIFO mode drains every sample"){
+	std::vector<mpuSample> trace;
+	for(int16_t i = 0; i < 10; i++){
+		trace.push_back(mpuSample{0, i, 0, 0, 0, int16_t(-i), 0, 0});
+	}
+	mpuReplayBus bus;
+	bus.setTrace(trace, false);
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	mpu.enableFifo(MPU6050::FIFO_ACCEL | MPU6050::FIFO_GYRO, 0);
+	mpuDataReady sensor(mpu, hwlib::pin_in_dummy, true);
+	sensor.begin();
+	REQUIRE(bus.getRegister(mpuReplayBus::REG_INT_ENABLE) == (MPU6050::INT_FIFO_OVERFLOW | MPU6050::INT_DATA_READY));
+	
+	bus.advance(10);
+	bus.resetCounters();
+	sensor.onInterrupt();
+	REQUIRE(sensor.update());
+	// INT_STATUS once, the FIFO count and one burst
+	REQUIRE(bus.getTransactions() == 6);
+	mpuSample sample;
+	REQUIRE(sensor.getLatest(sample) == 1);
+	REQUIRE(sample.accelX == 9);
+	REQUIRE(sample.gyroX == -9);
+	REQUIRE(mpu.getFifoSamples().size() == 0);
+}
+
+TEST_CASE("mpuDataReady, a FIFO overflow is not lost"){
+	mpuReplayBus bus;
+	bus.setSynthetic(10, 100);
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	mpu.enableFifo(MPU6050::FIFO_ACCEL | MPU6050::FIFO_GYRO, 0);
+	mpuDataReady sensor(mpu, hwlib::pin_in_dummy, true);
+	sensor.begin();
+	
+	// 12 byte samples: the trimmed FIFO holds less than 1024 bytes, so only
+	// FIFO_OFLOW in INT_STATUS tells that samples were lost
+	bus.advance(100);
+	REQUIRE(bus.getFifoSize() < 1024);
+	sensor.onInterrupt();
+	REQUIRE_FALSE(sensor.update());
+	REQUIRE(mpu.getFifoOverflows() == 1);
+	REQUIRE(bus.getFifoSize() == 0);
+	
+	bus.advance(3);
+	sensor.onInterrupt();
+	REQUIRE(sensor.update());
+	REQUIRE(mpu.getFifoOverflows() == 1);
+}
+
+/* ------------- low power ------- */
+TEST_CASE("low power, cycle mode and wake on motion"){
+	mpuReplayBus bus;
+	bus.setSynthetic(0, 100, 2);
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	mpuConfig config;
+	config.clock = mpuClock::PLL_XGYRO;
+	mpu.configure(config);
+	mpu.enableInterrupt(MPU6050::INT_DATA_READY);
+	bus.advance();
+	
+	mpu.enableMotionInterrupt(40, 1);
+	mpu.enterLowPower(mpuWakeRate::HZ_5);
+	REQUIRE(mpu.isLowPower());
+	REQUIRE(bus.getRegister(mpuReplayBus::REG_MOT_THR) == 20);
+	REQUIRE(bus.getRegister(mpuReplayBus::REG_INT_ENABLE) == MPU6050::INT_MOTION);
+	REQUIRE(bus.getRegister(mpuReplayBus::REG_PWR_MGMT_1) == 0x28);
+	REQUIRE(bus.getRegister(0x6C) == 0x47);
+	
+	bus.advance(10);
+	REQUIRE_FALSE(mpu.getInterruptStatus() & MPU6050::INT_MOTION);
+	
+	bus.setSynthetic(30, 20);
+	bus.advance(5);
+	REQUIRE(mpu.getInterruptStatus() & MPU6050::INT_MOTION);
+	
+	mpu.exitLowPower();
+	REQUIRE_FALSE(mpu.isLowPower());
+	REQUIRE(bus.getRegister(mpuReplayBus::REG_PWR_MGMT_1) == 0x01);
+	REQUIRE(bus.getRegister(0x6C) == 0x00);
+	REQUIRE(bus.getRegister(mpuReplayBus::REG_INT_ENABLE) == MPU6050::INT_DATA_READY);
+	REQUIRE(bus.getRegister(mpuReplayBus::REG_ACCEL_CONFIG) == 0x00);
+}
+
+/* ------------- blocking calibration ------- */
+//Takes a sample before every read, so a blocking loop sees time pass
+class runningReplayBus : public mpuReplayBus{
+public:
+	void read(uint_fast8_t a, uint8_t data[], size_t n) override {
+		advance();
+		mpuReplayBus::read(a, data, n);
+	}
+};
+
+TEST_CASE("calibrate, still device"){
+	runningReplayBus bus;
+	bus.setSynthetic(0, 100, 0, 40);
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	REQUIRE(mpu.calibrate());
+	REQUIRE(mpu.getOffsetGyroX() == 40);
+}
+
+TEST_CASE("calibrate, gives up on a moving device"){
+	runningReplayBus bus;
+	bus.setSynthetic(30, 20);
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	mpu.setCalibration(mpuCalibration{1, 2, 3, 4, 5, 6});
+	uint_fast64_t start = hwlib::now_us();
+	REQUIRE_FALSE(mpu.calibrate(50));
+	REQUIRE(hwlib::now_us() - start >= 50000);
+	REQUIRE(mpu.getOffsetGyroX() == 4);
+	REQUIRE(mpu.getOffsetAccelZ() == 3);
+}
+
+/* ------------- consumers ------- */
+TEST_CASE("calibrator, still device"){
+	mpuReplayBus bus;
+	bus.setSynthetic(0, 100, 3, 40);
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	mpuCalibrator calibrator(mpu, 0);
+	calibrator.start();
+	unsigned int steps = 0;
+	while(!calibrator.step() && steps < 1000){
+		bus.advance();
+		++steps;
+	}
+	REQUIRE(calibrator.isCalibrated());
+	REQUIRE(steps < 1000);
+	REQUIRE(mpu.getOffsetGyroX() >= 38);
+	REQUIRE(mpu.getOffsetGyroX() <= 42);
+	REQUIRE(mpu.getOffsetAccelZ() >= -2);
+	REQUIRE(mpu.getOffsetAccelZ() <= 2);
+}
+
+TEST_CASE("calibrator, motion is rejected"){
+	mpuReplayBus bus;
+	bus.setSynthetic(30, 50);
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	mpuCalibrator calibrator(mpu, 0);
+	calibrator.start();
+	for(unsigned int i = 0; i < 500; i++){
+		bus.advance();
+		calibrator.step();
+	}
+	REQUIRE_FALSE(calibrator.isCalibrated());
+	REQUIRE(calibrator.getRejected() > 0);
+}
+
+TEST_CASE("calibrator, fed by mpuDataReady"){
+	mpuReplayBus bus;
+	bus.setSynthetic(0, 100, 3, 40);
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	mpuDataReady sensor(mpu, hwlib::pin_in_dummy);
+	sensor.begin();
+	mpuCalibrator calibrator(mpu);
+	calibrator.start();
+	unsigned int samples = 0;
+	bool calibrated = false;
+	while(!calibrated && samples < 1000){
+		bus.advance();
+		sensor.onInterrupt();
+		bus.resetCounters();
+		REQUIRE(sensor.update());
+		// the calibrator reads nothing itself, the bus only sees the sensor
+		REQUIRE(bus.getTransactions() == 4);
+		mpuSample sample;
+		sensor.getLatest(sample);
+		calibrated = calibrator.feed(sample);
+		++samples;
+	}
+	REQUIRE(calibrator.isCalibrated());
+	REQUIRE(mpu.getOffsetGyroX() >= 38);
+	REQUIRE(mpu.getOffsetGyroX() <= 42);
+}
+
+TEST_CASE("calibrator, tracking from a stored calibration"){
+	mpuReplayBus bus;
+	bus.setSynthetic(0, 100, 3, 40);
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	mpu.setCalibration(mpuCalibration{0, 0, 0, 35, 35, 35});
+	mpuCalibrator calibrator(mpu, 0);
+	calibrator.track();
+	REQUIRE(calibrator.isCalibrated());
+	for(unsigned int i = 0; i < 2000; i++){
+		bus.advance();
+		REQUIRE(calibrator.step());
+	}
+	REQUIRE(calibrator.getCount() == 0);
+	REQUIRE(mpu.getOffsetGyroX() >= 38);
+	REQUIRE(mpu.getOffsetGyroX() <= 42);
+}
+
+TEST_CASE("calibrator, tracking rounds a positive and a negative bias alike"){
+	for(int16_t bias : {40, -40}){
+		mpuReplayBus bus;
+		bus.setSynthetic(0, 100, 0, bias);
+		MPU6050 mpu(bus);
+		mpu.wakeUp();
+		int16_t stored = bias > 0 ? 35 : -35;
+		mpu.setCalibration(mpuCalibration{0, 0, 0, stored, stored, stored});
+		mpuCalibrator calibrator(mpu, 0);
+		calibrator.track();
+		for(unsigned int i = 0; i < 2000; i++){
+			bus.advance();
+			calibrator.step();
+		}
+		REQUIRE(mpu.getOffsetGyroX() == bias);
+		REQUIRE(mpu.getOffsetGyroZ() == bias);
+	}
+}
+
+TEST_CASE("orientation filter, follows the synthetic tilt"){
+	mpuReplayBus bus;
+	bus.setSynthetic(30, 400);
+	MPU6050 mpu(bus);
+	mpu.wakeUp();
+	mpuConfig config;
+	config.dlpf = mpuDlpf::BW_44HZ;
+	config.sampleRateDivider = 9;
+	mpu.configure(config);
+	mpu.enableFifo(MPU6050::FIFO_ACCEL | MPU6050::FIFO_GYRO, 9);
+	orientationFilter filter;
+	mpuSample sample;
+	mpuScaledSample scaled;
+	for(unsigned int i = 0; i < 500; i++){
+		bus.advance();
+		mpu.drainFifo();
+		while(mpu.getFifoSamples().pop(sample)){
+			sample.timestamp = uint_fast64_t(i) * 10000;
+			mpu.scale(sample, scaled);
+			filter.update(scaled);
+		}
+	}
+	// 500 samples is a period and a quarter: at the top of the sine
+	REQUIRE(filter.getRoll() > 29000);
+	REQUIRE(filter.getRoll() < 31000);
+	REQUIRE(filter.getPitch() > -1000);
+	REQUIRE(filter.getPitch() < 1000);
+}
@@ -0,0 +1,407 @@
+#ifndef MPUREPLAYBUS_HPP
+#define MPUREPLAYBUS_HPP
+#include "hwlib.hpp"
+#include "mpuSample.hpp"
+#include "i2cRegisterBus.hpp"
+#include "mpuTrace.hpp"
+#include <cmath>
+#include <deque>
+#include <vector>
+
+/// \brief
+/// I2C register bus with a simulated MPU6050 on it, for host tests
+/// \details
+/// Behaves like the register file of an MPU6050: the first byte of a write
+/// sets the register pointer, further bytes are written to consecutive
+/// registers, reads continue from the pointer. Reading FIFO_R_W pops the FIFO
+/// and reading INT_STATUS clears it.
+///
+/// Time only moves with advance(): every sample taken is loaded in the output
+/// registers, pushed to the FIFO when it is enabled and sets the data ready
+/// flag. With the motion interrupt enabled and the accelerometer high pass
+/// filter on hold, a sample that differs more than MOT_THR from the sample
+/// at the moment of the hold sets the motion flag. Samples come from a
+/// trace, loaded with loadTrace() or given with setTrace(), or from a
+/// synthetic tilting motion. Every read and write call is counted, so tests
+/// can check how many transactions a driver call costs.
+class mpuReplayBus : public i2cRegisterBus{
+public:
+	static const uint8_t WHO_AM_I_VALUE = 0x68;
+	
+	//Registers with a side effect
+	static const uint8_t REG_SMPLRT_DIV = 0x19;
+	static const uint8_t REG_CONFIG = 0x1A;
+	static const uint8_t REG_ACCEL_CONFIG = 0x1C;
+	static const uint8_t REG_MOT_THR = 0x1F;
+	static const uint8_t REG_INT_ENABLE = 0x38;
+	static const uint8_t REG_FIFO_EN = 0x23;
+	static const uint8_t REG_INT_STATUS = 0x3A;
+	static const uint8_t REG_ACCEL_XOUT_H = 0x3B;
+	static const uint8_t REG_USER_CTRL = 0x6A;
+	static const uint8_t REG_PWR_MGMT_1 = 0x6B;
+	static const uint8_t REG_FIFO_COUNT_H = 0x72;
+	static const uint8_t REG_FIFO_COUNT_L = 0x73;
+	static const uint8_t REG_FIFO_R_W = 0x74;
+	static const uint8_t REG_WHO_AM_I = 0x75;
+	
+	static const unsigned int FIFO_SIZE = 1024;
+	
+private:
+	uint8_t deviceAddress;
+	uint8_t registers[128];
+	uint8_t pointer = 0;
+	std::deque<uint8_t> fifo;
+	
+	std::vector<mpuSample> trace;
+	//Samples from a file, in milli-g and milli-degrees per second
+	std::vector<mpuScaledSample> recorded;
+	unsigned int traceIndex = 0;
+	bool loop = true;
+	
+	//Synthetic motion, used when there is no trace
+	int16_t amplitude = 0;
+	unsigned int periodSamples = 1;
+	int16_t noise = 0;
+	int16_t gyroBias = 0;
+	uint32_t noiseState = 1;
+	
+	//Accelerometer value held by the high pass filter, for motion detection
+	int16_t reference[3] = {};
+	int16_t lastAccel[3] = {};
+	
+	uint64_t sampleCount = 0;
+	uint32_t elapsedUs = 0;
+	
+	unsigned int writes = 0;
+	unsigned int reads = 0;
+	unsigned int bytes = 0;
+	unsigned int wrongAddress = 0;
+	
+	void reset(){
+		for(uint8_t & r : registers){
+			r = 0;
+		}
+		registers[REG_PWR_MGMT_1] = 0x40;
+		registers[REG_WHO_AM_I] = WHO_AM_I_VALUE;
+		fifo.clear();
+	}
+	
+	void writeRegister(const uint8_t & address, const uint8_t & value){
+		if(address == REG_PWR_MGMT_1 && (value & 0x80)){
+			reset();
+			return;
+		}
+		if(address == REG_USER_CTRL && (value & 0x04)){
+			fifo.clear();
+			registers[address] = value & ~0x04;
+			return;
+		}
+		if(address == REG_FIFO_R_W || address == REG_WHO_AM_I || address == REG_INT_STATUS){
+			return;
+		}
+		if(address == REG_ACCEL_CONFIG && (value & 0x07) == 0x07){
+			for(unsigned int i = 0; i < 3; i++){
+				reference[i] = lastAccel[i];
+			}
+		}
+		registers[address & 0x7F] = value;
+	}
+	
+	uint8_t readRegister(const uint8_t & address){
+		switch(address){
+			case REG_FIFO_R_W: {
+				if(fifo.empty()){
+					return 0;
+				}
+				uint8_t value = fifo.front();
+				fifo.pop_front();
+				return value;
+			}
+			case REG_FIFO_COUNT_H:
+				return fifo.size() >> 8;
+			case REG_FIFO_COUNT_L:
+				return fifo.size() & 0xFF;
+			case REG_INT_STATUS: {
+				uint8_t value = registers[REG_INT_STATUS];
+				registers[REG_INT_STATUS] = 0;
+				return value;
+			}
+			default:
+				return registers[address & 0x7F];
+		}
+	}
+	
+	//Index of the next trace sample, wraps or repeats the last one
+	unsigned int nextIndex(const unsigned int & size){
+		if(traceIndex >= size){
+			traceIndex = loop ? 0 : size - 1;
+		}
+		return traceIndex++;
+	}
+	
+	//Raw value of a scaled one, per 1000 units of scaled
+	static int16_t raw(const int32_t & scaled, const double & rawPerUnit){
+		return int16_t(std::lround(scaled * rawPerUnit / 1000));
+	}
+	
+	mpuSample nextSample(){
+		if(!trace.empty()){
+			return trace[nextIndex(trace.size())];
+		}
+		uint8_t accelRange = (registers[0x1C] >> 3) & 0x03;
+		uint8_t gyroRange = (registers[0x1B] >> 3) & 0x03;
+		double oneG = 16384 >> accelRange;
+		double lsbPerDps = 131.0 / (1 << gyroRange);
+		if(!recorded.empty()){
+			// converted at the ranges configured now
+			const mpuScaledSample & scaled = recorded[nextIndex(recorded.size())];
+			mpuSample sample = {};
+			sample.accelX = raw(scaled.accelX, oneG);
+			sample.accelY = raw(scaled.accelY, oneG);
+			sample.accelZ = raw(scaled.accelZ, oneG);
+			sample.temperature = -521;
+			sample.gyroX = raw(scaled.gyroX, lsbPerDps);
+			sample.gyroY = raw(scaled.gyroY, lsbPerDps);
+			sample.gyroZ = raw(scaled.gyroZ, lsbPerDps);
+			return sample;
+		}
+		// Tilting around X: gravity moves between Z and Y, gyro X is the
+		// derivative of the angle, all in raw units at the configured ranges.
+		const double pi = 3.14159265358979;
+		double phase = 2 * pi * double(sampleCount % periodSamples) / periodSamples;
+		double angle = amplitude * std::sin(phase);
+		double rateDps = amplitude * std::cos(phase) * 2 * pi * getSampleRateHz() / periodSamples;
+		double rad = angle * pi / 180;
+		mpuSample sample = {};
+		sample.accelY = int16_t(oneG * std::sin(rad)) + jitter();
+		sample.accelZ = int16_t(oneG * std::cos(rad)) + jitter();
+		sample.accelX = jitter();
+		sample.temperature = -521 + jitter();
+		sample.gyroX = int16_t(rateDps * lsbPerDps) + gyroBias + jitter();
+		sample.gyroY = gyroBias + jitter();
+		sample.gyroZ = gyroBias + jitter();
+		return sample;
+	}
+	
+	int16_t jitter(){
+		if(noise == 0){
+			return 0;
+		}
+		noiseState = noiseState * 1103515245 + 12345;
+		return int16_t((noiseState >> 16) % (2 * noise + 1)) - noise;
+	}
+	
+	static void store(uint8_t data[], const int16_t & value){
+		data[0] = uint16_t(value) >> 8;
+		data[1] = value & 0xFF;
+	}
+	
+	void pushFifo(const uint8_t data[], const unsigned int & count){
+		for(unsigned int i = 0; i < count; i++){
+			fifo.push_back(data[i]);
+		}
+	}
+	
+	void sample(){
+		mpuSample next = nextSample();
+		++sampleCount;
+		uint8_t data[14];
+		store(data, next.accelX);
+		store(data + 2, next.accelY);
+		store(data + 4, next.accelZ);
+		store(data + 6, next.temperature);
+		store(data + 8, next.gyroX);
+		store(data + 10, next.gyroY);
+		store(data + 12, next.gyroZ);
+		for(unsigned int i = 0; i < 14; i++){
+			registers[REG_ACCEL_XOUT_H + i] = data[i];
+		}
+		registers[REG_INT_STATUS] |= 0x01;
+		
+		int16_t accel[3] = {next.accelX, next.accelY, next.accelZ};
+		bool hold = (registers[REG_ACCEL_CONFIG] & 0x07) == 0x07;
+		int32_t oneG = 16384 >> ((registers[REG_ACCEL_CONFIG] >> 3) & 0x03);
+		for(unsigned int i = 0; i < 3; i++){
+			lastAccel[i] = accel[i];
+			int32_t differenceMg = std::abs(int32_t(accel[i]) - reference[i]) * 1000 / oneG;
+			if(hold && (registers[REG_INT_ENABLE] & 0x40) && differenceMg > 2 * registers[REG_MOT_THR]){
+				registers[REG_INT_STATUS] |= 0x40;
+			}
+		}
+		
+		uint8_t sensors = registers[REG_FIFO_EN];
+		if(!(registers[REG_USER_CTRL] & 0x40) || sensors == 0){
+			return;
+		}
+		unsigned int before = fifo.size();
+		if(sensors & 0x08){
+			pushFifo(data, 6);
+		}
+		if(sensors & 0x80){
+			pushFifo(data + 6, 2);
+		}
+		for(unsigned int i = 0; i < 3; i++){
+			if(sensors & (0x40 >> i)){
+				pushFifo(data + 8 + 2 * i, 2);
+			}
+		}
+		unsigned int size = fifo.size() - before;
+		while(fifo.size() > FIFO_SIZE){
+			fifo.erase(fifo.begin(), fifo.begin() + size);
+			registers[REG_INT_STATUS] |= 0x10;
+		}
+	}
+	
+public:
+	mpuReplayBus(const uint8_t & address = 0x68):
+		deviceAddress(address)
+	{
+		reset();
+	}
+	
+	void write(uint_fast8_t a, const uint8_t data[], size_t n) override {
+		++writes;
+		bytes += n;
+		if(a != deviceAddress){
+			++wrongAddress;
+			return;
+		}
+		if(n == 0){
+			return;
+		}
+		pointer = data[0] & 0x7F;
+		for(size_t i = 1; i < n; i++){
+			writeRegister(pointer, data[i]);
+			if(pointer != REG_FIFO_R_W){
+				pointer = (pointer + 1) & 0x7F;
+			}
+		}
+	}
+	
+	void read(uint_fast8_t a, uint8_t data[], size_t n) override {
+		++reads;
+		bytes += n;
+		if(a != deviceAddress){
+			++wrongAddress;
+			return;
+		}
+		for(size_t i = 0; i < n; i++){
+			data[i] = readRegister(pointer);
+			if(pointer != REG_FIFO_R_W){
+				pointer = (pointer + 1) & 0x7F;
+			}
+		}
+	}
+	
+	/// \brief
+	/// Replays samples from a file, returns false if it can't be read
+	/// \details
+	/// The file has the format of loadMpuTrace(), the same recordings the
+	/// benchmark reads. Every sample is converted to raw register values at
+	/// the ranges configured when it is taken, the timestamps and reference
+	/// angles are not used.
+	bool loadTrace(const char * fileName, const bool & repeat = true){
+		std::vector<mpuTraceLine> lines;
+		if(!loadMpuTrace(fileName, lines)){
+			return false;
+		}
+		trace.clear();
+		recorded.clear();
+		for(const mpuTraceLine & line : lines){
+			recorded.push_back(line.sample);
+		}
+		traceIndex = 0;
+		loop = repeat;
+		return true;
+	}
+	
+	/// \brief
+	/// Replays the given samples, from the start or repeating the last one
+	void setTrace(const std::vector<mpuSample> & samples, const bool & repeat = true){
+		trace = samples;
+		recorded.clear();
+		traceIndex = 0;
+		loop = repeat;
+	}
+	
+	/// \brief
+	/// Generates a tilt around X of amplitudeDegrees, periodSamples long
+	/// \details
+	/// noise is the maximum random deviation in raw units, gyroBias is added to
+	/// every gyro axis. An amplitude of 0 is a device lying still.
+	void setSynthetic(const int16_t & amplitudeDegrees, const unsigned int & period, const int16_t & noiseRaw = 0, const int16_t & bias = 0){
+		trace.clear();
+		recorded.clear();
+		amplitude = amplitudeDegrees;
+		periodSamples = period > 0 ? period : 1;
+		noise = noiseRaw;
+		gyroBias = bias;
+	}
+	
+	/// \brief
+	/// Returns the sample rate set by SMPLRT_DIV and CONFIG
+	uint32_t getSampleRateHz(){
+		uint8_t dlpf = registers[REG_CONFIG] & 0x07;
+		uint32_t gyroRate = (dlpf == 0 || dlpf == 7) ? 8000 : 1000;
+		return gyroRate / (1 + registers[REG_SMPLRT_DIV]);
+	}
+	
+	/// \brief
+	/// Takes count samples, nothing happens while the device sleeps
+	void advance(const unsigned int & count = 1){
+		if(registers[REG_PWR_MGMT_1] & 0x40){
+			return;
+		}
+		for(unsigned int i = 0; i < count; i++){
+			sample();
+		}
+	}
+	
+	/// \brief
+	/// Takes the samples that fit in us microseconds at the current rate
+	void advanceUs(const uint32_t & us){
+		elapsedUs += us;
+		uint32_t period = 1000000 / getSampleRateHz();
+		advance(elapsedUs / period);
+		elapsedUs %= period;
+	}
+	
+	uint8_t getRegister(uint8_t address){
+		return registers[address & 0x7F];
+	}
+	
+	unsigned int getFifoSize(){
+		return fifo.size();
+	}
+	
+	unsigned int getWrites(){
+		return writes;
+	}
+	
+	unsigned int getReads(){
+		return reads;
+	}
+	
+	/// \brief
+	/// Returns the number of read and write calls
+	unsigned int getTransactions(){
+		return writes + reads;
+	}
+	
+	unsigned int getBytes(){
+		return bytes;
+	}
+	
+	unsigned int getWrongAddress(){
+		return wrongAddress;
+	}
+	
+	void resetCounters(){
+		writes = 0;
+		reads = 0;
+		bytes = 0;
+		wrongAddress = 0;
+	}
+};
+
+#endif // MPUREPLAYBUS_HPP
@@ -0,0 +1,45 @@
+#ifndef MPUTRACE_HPP
+#define MPUTRACE_HPP
+#include "mpuSample.hpp"
+#include <cstdio>
+#include <vector>
+
+/// \brief
+/// One line of a recorded MPU6050 trace
+/// \details
+/// The scaled sample and the reference pitch and roll in milli-degrees, for
+/// judging the orientation filter. The temperature is not recorded.
+struct mpuTraceLine{
+	mpuScaledSample sample;
+	int32_t pitch;
+	int32_t roll;
+};
+
+/// \brief
+/// Reads a trace file, returns false if it can't be opened
+/// \details
+/// One sample per line, integers separated by commas:
+/// timestamp_us,accelX_mg,accelY_mg,accelZ_mg,gyroX_mdps,gyroY_mdps,gyroZ_mdps,pitch_mdeg,roll_mdeg
+///
+/// Reading stops at the first line that does not have all nine fields. Used
+/// by mpuReplayBus::loadTrace() and the orientation filter benchmark, so one
+/// recording serves both.
+inline bool loadMpuTrace(const char * fileName, std::vector<mpuTraceLine> & trace){
+	FILE * file = fopen(fileName, "r");
+	if(file == nullptr){
+		return false;
+	}
+	long long timestamp;
+	long ax, ay, az, gx, gy, gz, pitch, roll;
+	while(fscanf(file, "%lld,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld", &timestamp, &ax, &ay, &az, &gx, &gy, &gz, &pitch, &roll) == 9){
+		mpuTraceLine line = {};
+		line.sample = mpuScaledSample{uint_fast64_t(timestamp), int32_t(ax), int32_t(ay), int32_t(az), 0, int32_t(gx), int32_t(gy), int32_t(gz)};
+		line.pitch = pitch;
+		line.roll = roll;
+		trace.push_back(line);
+	}
+	fclose(file);
+	return true;
+}
+
+#endif // MPUTRACE_HPP
@@ -0,0 +1,713 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
+#include "catch.hpp"
+
+#include "hwlib.hpp"
+#include "lightMenu.hpp"
+#include "ledMatrixMenu.hpp"
+#include "oledmenu.hpp"
+#include "buttonInput.hpp"
+#include <string>
+//Tests of the menu and its displays. The displays are checked against the
+//buffer of the ledMatrixSet, so no leds are needed.
+
+//A menu three levels deep, the numbers are the action indexes
+constexpr lightMenu::menuEntry outline[] = {
+	{"Start", 0, 0},
+	{"Settings", 0, lightMenu::MENU_SUBMENU},
+	{"Sound", 1, lightMenu::MENU_SUBMENU},
+	{"Aan", 2, 1},
+	{"Uit", 2, 2},
+	{"Terug", 2, lightMenu::MENU_BACK},
+	{"Beginner", 1, 3},
+	{"Terug", 1, lightMenu::MENU_BACK},
+	{"Info", 0, 4}
+};
+constexpr auto layout = lightMenu::makeMenuTable(outline);
+const unsigned int TOP = 9;
+
+//Table order: the top menu, then the menus in the order they are found
+//Start Settings Info | Sound Beginner Terug | Aan Uit Terug
+static_assert(layout.rootCount == 3, "three entries in the top menu");
+static_assert(layout.entries[2].action == 4, "Info is the last top entry");
+static_assert(layout.entries[4].action == 3, "Beginner follows Sound");
+static_assert(layout.entries[7].action == 2, "Uit is in the Sound menu");
+
+static_assert(layout.parent[0] == TOP && layout.parent[1] == TOP && layout.parent[2] == TOP, "top entries");
+static_assert(layout.parent[3] == 1 && layout.parent[4] == 1 && layout.parent[5] == 1, "Settings entries");
+static_assert(layout.parent[6] == 3 && layout.parent[7] == 3 && layout.parent[8] == 3, "Sound entries");
+
+static_assert(layout.firstChild[1] == 3 && layout.childCount[1] == 3, "Settings menu");
+static_assert(layout.firstChild[3] == 6 && layout.childCount[3] == 3, "Sound menu");
+static_assert(layout.childCount[0] == 0 && layout.childCount[2] == 0 && layout.childCount[4] == 0, "actions have no menu");
+static_assert(layout.childCount[5] == 0 && layout.childCount[8] == 0, "back entries have no menu");
+
+static_assert(layout.position[0] == 0 && layout.position[1] == 1 && layout.position[2] == 2, "top positions");
+static_assert(layout.position[3] == 0 && layout.position[4] == 1 && layout.position[5] == 2, "Settings positions");
+static_assert(layout.position[6] == 0 && layout.position[7] == 1 && layout.position[8] == 2, "Sound positions");
+
+class nameItem : public lightMenu::menuItem{
+	public:
+		nameItem(hwlib::string<0> name):
+			lightMenu::menuItem(name)
+		{}
+		void run(){
+			runs++;
+		}
+		int runs = 0;
+};
+
+//An action that takes a number of steps
+class stepItem : public lightMenu::menuItem{
+	public:
+		stepItem(hwlib::string<0> name, const unsigned int & steps):
+			lightMenu::menuItem(name),
+			steps(steps)
+		{}
+		void run(){}
+		bool start(){
+			starts++;
+			done = 0;
+			return done < steps;
+		}
+		bool step(){
+			done++;
+			return done < steps;
+		}
+		void cancel(){
+			cancels++;
+		}
+		unsigned int getProgress() const{
+			return done * 100 / steps;
+		}
+		unsigned int steps;
+		unsigned int done = 0;
+		int starts = 0;
+		int cancels = 0;
+};
+
+//An i2c bus that keeps the last data written to every OLED page
+class pageBus : public hwlib::i2c_bus{
+	public:
+		uint8_t pages[8][129] = {};
+		unsigned int writes = 0;
+		unsigned int page = 0;
+		void write(uint_fast8_t a, const uint8_t data[], size_t n) override {
+			if(data[0] == 0x00){
+				page = data[5];
+				writes++;
+			}else{
+				for(size_t i = 0; i < n && i < 129; i++){
+					pages[page][i] = data[i];
+				}
+			}
+		}
+		void read(uint_fast8_t a, uint8_t data[], size_t n) override {}
+		
+		bool hasMarker(const unsigned int & p){
+			for(unsigned int x = 1; x <= 8; x++){
+				if(pages[p][x] != 0){
+					return true;
+				}
+			}
+			return false;
+		}
+		
+		//True when page p shows the label of item after the marker
+		bool shows(const unsigned int & p, const lightMenu::menuItem & item){
+			const lightMenu::menuLabel & label = *item.getLabel();
+			for(unsigned int x = 0; x < 120; x++){
+				uint8_t column = x < label.width ? label.columns[x] : 0;
+				if(pages[p][9 + x] != column){
+					return false;
+				}
+			}
+			return true;
+		}
+};
+
+//A button pin the test presses and releases
+class levelPin : public hwlib::pin_in{
+	public:
+		bool level = false;
+		bool get(hwlib::buffering buf = hwlib::buffering::unbuffered) override {
+			return level;
+		}
+};
+
+//True when the chain shows exactly label, first letter on the left like
+//ledMatrixMenu draws it
+template<unsigned int n>
+bool showsLabel(max7219::ledMatrixSet<n> & matrices, const lightMenu::menuLabel & label){
+	for(int row = 0; row < 8; row++){
+		for(unsigned int c = 0; c < n * 8; c++){
+			if(matrices.getPixel(n * 8 - 1 - c, row) != label.getPixel(c, row)){
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+//True when the chain shows exactly the label of item
+template<unsigned int n>
+bool showsLabel(max7219::ledMatrixSet<n> & matrices, const lightMenu::menuItem & item){
+	return showsLabel(matrices, *item.getLabel());
+}
+
+//Runs the marquee and transition of display to their end
+template<unsigned int n>
+void settle(ledMatrixMenu<n> & display){
+	for(int i = 0; i < 20; i++){
+		display.update();
+	}
+}
+
+
+/* ------------- ledMatrixMenu ------- */
+TEST_CASE("ledMatrixMenu, a transition ends on the new name"){
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<4> matrices(spi_bus);
+	matrices.resetRegisters();
+	
+	hwlib::string<4> first;
+	first.clear() << "Een";
+	hwlib::string<4> second;
+	second.clear() << "Twee";
+	nameItem one(first);
+	nameItem two(second);
+	std::array<lightMenu::menuItem*, 2> items = {&one, &two};
+	lightMenu::menu<2> mainMenu(items);
+	std::array<lightMenu::menu<2>*, 1> menus = {&mainMenu};
+	lightMenu::baseMenu<1, 2> base(menus);
+	
+	ledMatrixMenu<4> display(base, matrices, 0);
+	display.draw();
+	REQUIRE(showsLabel(matrices, one));
+	
+	base.cursorDown();
+	display.draw();
+	REQUIRE_FALSE(showsLabel(matrices, two));
+	settle(display);
+	REQUIRE(showsLabel(matrices, two));
+	
+	base.cursorUp();
+	display.draw();
+	settle(display);
+	REQUIRE(showsLabel(matrices, one));
+}
+
+TEST_CASE("ledMatrixMenu, shows the entries of a tableMenu"){
+	auto spi_bus = max7219::spiBusLed(hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_out_dummy, hwlib::pin_in_dummy);
+	max7219::ledMatrixSet<8> matrices(spi_bus);
+	matrices.resetRegisters();
+	
+	//eight modules, so no name is long enough to scroll
+	hwlib::string<6> startName;
+	startName.clear() << "Start";
+	nameItem start(startName);
+	std::array<lightMenu::menuItem*, 5> actions = {&start};
+	lightMenu::tableMenu<9, 5> menu(layout, actions);
+	
+	ledMatrixMenu<8> display(menu, matrices, 0);
+	display.draw();
+	REQUIRE(showsLabel(matrices, start));
+	
+	lightMenu::menuLabel settings;
+	settings.render("Settings");
+	menu.cursorDown();
+	display.draw();
+	settle(display);
+	REQUIRE(showsLabel(matrices, settings));
+	
+	lightMenu::menuLabel sound;
+	sound.render("Sound");
+	menu.select();
+	display.draw();
+	settle(display);
+	REQUIRE(showsLabel(matrices, sound));
+}
+
+
+/* ------------- tableMenu ------- */
+TEST_CASE("tableMenu, navigate a nested menu"){
+	hwlib::string<4> name;
+	name.clear() << "Aan";
+	nameItem on(name);
+	nameItem info(name);
+	std::array<lightMenu::menuItem*, 5> actions = {NULL, &on, NULL, NULL, &info};
+	lightMenu::tableMenu<9, 5> menu(layout, actions);
+	
+	REQUIRE(menu.getCurrentMenuId() == TOP);
+	REQUIRE(menu.getCurrentMenuSize() == 3);
+	REQUIRE(std::string(menu.getCurrentLabel(2)) == "Info");
+	REQUIRE(menu.getCurrentLabel(3) == NULL);
+	
+	menu.setCursorPos(1);
+	menu.select();
+	REQUIRE(menu.getCurrentMenuId() == 1);
+	REQUIRE(menu.getCurrentCursorPos() == 0);
+	menu.select();
+	REQUIRE(menu.getCurrentMenuId() == 3);
+	REQUIRE(std::string(menu.getCurrentLabel(0)) == "Aan");
+	
+	menu.select();
+	REQUIRE(on.runs == 1);
+	REQUIRE(menu.getCurrentMenuId() == 3);
+	
+	menu.cursorDown();
+	menu.cursorDown();
+	menu.cursorDown();
+	REQUIRE(menu.getCurrentCursorPos() == 2);
+	menu.select();
+	REQUIRE(menu.getCurrentMenuId() == 1);
+	REQUIRE(menu.getCurrentCursorPos() == 0);
+	
+	menu.previousMenu();
+	REQUIRE(menu.getCurrentMenuId() == TOP);
+	REQUIRE(menu.getCurrentCursorPos() == 1);
+	menu.previousMenu();
+	REQUIRE(menu.getCurrentMenuId() == TOP);
+	
+	menu.setCursorPos(3);
+	REQUIRE(menu.getCurrentCursorPos() == 1);
+	menu.cursorDown();
+	menu.select();
+	REQUIRE(info.runs == 1);
+}
+
+TEST_CASE("tableMenu, labels come from the table or the item"){
+	hwlib::string<6> name;
+	name.clear() << "Start";
+	nameItem start(name);
+	std::array<lightMenu::menuItem*, 5> actions = {&start};
+	unsigned int used = lightMenu::menuLabelPool::get().getUsed();
+	{
+		lightMenu::tableMenu<9, 5> menu(layout, actions);
+		
+		unsigned int revision = 1;
+		REQUIRE(menu.getLabel(0, revision) == start.getLabel());
+		REQUIRE(revision == start.getRevision());
+		
+		lightMenu::menuLabel settings;
+		settings.render("Settings");
+		const lightMenu::menuLabel * label = menu.getLabel(1, revision);
+		REQUIRE(label != NULL);
+		REQUIRE(revision == 0);
+		REQUIRE(label->width == settings.width);
+		for(unsigned int x = 0; x < settings.width; x++){
+			REQUIRE(label->columns[x] == settings.columns[x]);
+		}
+		REQUIRE(menu.getLabel(3, revision) == NULL);
+		
+		hwlib::string<6> newName;
+		newName.clear() << "Go";
+		start.setName(newName);
+		menu.getLabel(0, revision);
+		REQUIRE(revision == start.getRevision());
+	}
+	REQUIRE(lightMenu::menuLabelPool::get().getUsed() == used);
+}
+
+
+/* ------------- menu ------- */
+TEST_CASE("menu, the array constructor moves the items together"){
+	hwlib::string<2> name;
+	name.clear() << "A";
+	nameItem a(name);
+	nameItem b(name);
+	std::array<lightMenu::menuItem*, 4> items = {NULL, &a, NULL, &b};
+	lightMenu::menu<4> list(items);
+	REQUIRE(list.getMenuItemArraySize() == 2);
+	REQUIRE(list.getMenuItemByIndex(0) == &a);
+	REQUIRE(list.getMenuItemByIndex(1) == &b);
+	REQUIRE(list.getMenuItemByIndex(2) == NULL);
+	REQUIRE(list.getMenuItemByIndex(-1) == NULL);
+}
+
+TEST_CASE("menu, add and insert"){
+	hwlib::string<2> name;
+	name.clear() << "A";
+	nameItem a(name);
+	nameItem b(name);
+	nameItem c(name);
+	nameItem d(name);
+	lightMenu::menu<4> list;
+	REQUIRE(list.addMenuItem(&a));
+	REQUIRE(list.addMenuItem(&c));
+	REQUIRE_FALSE(list.addMenuItem(NULL));
+	
+	//in the middle, the items after it move up
+	REQUIRE(list.insertMenuItem(1, &b));
+	REQUIRE(list.getMenuItemArraySize() == 3);
+	REQUIRE(list.getMenuItemByIndex(0) == &a);
+	REQUIRE(list.getMenuItemByIndex(1) == &b);
+	REQUIRE(list.getMenuItemByIndex(2) == &c);
+	
+	//past the end is added at the end
+	REQUIRE(list.insertMenuItem(10, &d));
+	REQUIRE(list.getMenuItemArraySize() == 4);
+	REQUIRE(list.getMenuItemByIndex(3) == &d);
+	
+	//full
+	REQUIRE_FALSE(list.insertMenuItem(0, &a));
+	REQUIRE_FALSE(list.addMenuItem(&a));
+	REQUIRE(list.getMenuItemArraySize() == 4);
+	REQUIRE(list.getMenuItemByIndex(0) == &a);
+}
+
+TEST_CASE("menu, insert at the end"){
+	hwlib::string<2> name;
+	name.clear() << "A";
+	nameItem a(name);
+	nameItem b(name);
+	lightMenu::menu<4> list;
+	list.addMenuItem(&a);
+	REQUIRE(list.insertMenuItem(1, &b));
+	REQUIRE(list.getMenuItemArraySize() == 2);
+	REQUIRE(list.getMenuItemByIndex(1) == &b);
+}
+
+TEST_CASE("menu, remove"){
+	hwlib::string<2> name;
+	name.clear() << "A";
+	nameItem a(name);
+	nameItem b(name);
+	nameItem c(name);
+	std::array<lightMenu::menuItem*, 4> items = {&a, &b, &c};
+	lightMenu::menu<4> list(items);
+	
+	//from the middle, the items after it move down
+	REQUIRE(list.removeMenuItem(1));
+	REQUIRE(list.getMenuItemArraySize() == 2);
+	REQUIRE(list.getMenuItemByIndex(0) == &a);
+	REQUIRE(list.getMenuItemByIndex(1) == &c);
+	REQUIRE(list.getMenuItemByIndex(2) == NULL);
+	
+	//the last item
+	REQUIRE(list.removeMenuItem(1));
+	REQUIRE(list.getMenuItemArraySize() == 1);
+	REQUIRE(list.getMenuItemByIndex(1) == NULL);
+	
+	REQUIRE_FALSE(list.removeMenuItem(1));
+	REQUIRE(list.removeMenuItem(0));
+	REQUIRE(list.getMenuItemArraySize() == 0);
+	REQUIRE_FALSE(list.removeMenuItem(0));
+	
+	//the freed places can be used again
+	REQUIRE(list.addMenuItem(&b));
+	REQUIRE(list.getMenuItemByIndex(0) == &b);
+}
+
+
+/* ------------- baseMenu ------- */
+TEST_CASE("baseMenu, addMenu fills the free places"){
+	lightMenu::menu<2> first;
+	lightMenu::menu<2> second;
+	lightMenu::menu<2> third;
+	std::array<lightMenu::menu<2>*, 2> menus = {&first};
+	lightMenu::baseMenu<2, 2> base(menus);
+	REQUIRE(base.getMenuCount() == 1);
+	REQUIRE_FALSE(base.addMenu(NULL));
+	
+	REQUIRE(base.addMenu(&second));
+	REQUIRE(base.getMenuCount() == 2);
+	REQUIRE(base.getMenuByIndex(1) == &second);
+	REQUIRE(second.getBaseMenuPosition() == 1);
+	REQUIRE(base.getMenuByIndex(0) == &first);
+	
+	REQUIRE_FALSE(base.addMenu(&third));
+	REQUIRE(base.getMenuCount() == 2);
+	REQUIRE(base.getMenuByIndex(1) == &second);
+}
+
+
+/* ------------- buttons ------- */
+TEST_CASE("debouncedButton, bounces after an edge are ignored"){
+	levelPin pin;
+	debouncedButton button;
+	button.setPin(pin);
+	button.debounceUs = 10000;
+	buttonEvent event;
+	const uint_fast64_t start = 100000;
+	
+	pin.level = true;
+	REQUIRE(button.update(start, event));
+	REQUIRE(event.kind == buttonEvent::type::PRESS);
+	REQUIRE(event.timestamp == start);
+	
+	pin.level = false;
+	REQUIRE_FALSE(button.update(start + 2000, event));
+	pin.level = true;
+	REQUIRE_FALSE(button.update(start + 5000, event));
+	pin.level = false;
+	REQUIRE_FALSE(button.update(start + 9999, event));
+	REQUIRE(button.isPressed());
+	
+	REQUIRE(button.update(start + 10000, event));
+	REQUIRE(event.kind == buttonEvent::type::RELEASE);
+	REQUIRE_FALSE(button.isPressed());
+}
+
+TEST_CASE("debouncedButton, auto-repeat while held"){
+	levelPin pin;
+	debouncedButton button;
+	button.setPin(pin);
+	button.repeatDelayUs = 500000;
+	button.repeatPeriodUs = 150000;
+	button.longPressUs = 0;
+	buttonEvent event;
+	const uint_fast64_t start = 100000;
+	
+	pin.level = true;
+	REQUIRE(button.update(start, event));
+	REQUIRE(event.kind == buttonEvent::type::PRESS);
+	REQUIRE_FALSE(button.update(start + 499999, event));
+	
+	REQUIRE(button.update(start + 500000, event));
+	REQUIRE(event.kind == buttonEvent::type::REPEAT);
+	REQUIRE_FALSE(button.update(start + 500001, event));
+	REQUIRE_FALSE(button.update(start + 649999, event));
+	REQUIRE(button.update(start + 650000, event));
+	REQUIRE(event.kind == buttonEvent::type::REPEAT);
+	REQUIRE(button.update(start + 800000, event));
+	REQUIRE(event.kind == buttonEvent::type::REPEAT);
+	
+	pin.level = false;
+	REQUIRE(button.update(start + 850000, event));
+	REQUIRE(event.kind == buttonEvent::type::RELEASE);
+	REQUIRE_FALSE(button.update(start + 950000, event));
+}
+
+TEST_CASE("debouncedButton, one long press per hold"){
+	levelPin pin;
+	debouncedButton button;
+	button.setPin(pin);
+	button.repeatDelayUs = 0;
+	button.longPressUs = 1000000;
+	buttonEvent event;
+	const uint_fast64_t start = 100000;
+	
+	pin.level = true;
+	REQUIRE(button.update(start, event));
+	REQUIRE_FALSE(button.update(start + 999999, event));
+	REQUIRE(button.update(start + 1000000, event));
+	REQUIRE(event.kind == buttonEvent::type::LONG_PRESS);
+	REQUIRE_FALSE(button.update(start + 1500000, event));
+	REQUIRE_FALSE(button.update(start + 3000000, event));
+	
+	//the next hold gets its own
+	pin.level = false;
+	REQUIRE(button.update(start + 3100000, event));
+	REQUIRE(event.kind == buttonEvent::type::RELEASE);
+	pin.level = true;
+	REQUIRE(button.update(start + 3200000, event));
+	REQUIRE(event.kind == buttonEvent::type::PRESS);
+	REQUIRE(button.update(start + 4200000, event));
+	REQUIRE(event.kind == buttonEvent::type::LONG_PRESS);
+}
+
+TEST_CASE("buttonInput, a full queue drops the newest events"){
+	levelPin pins[3];
+	buttonInput<3, 2> input;
+	for(unsigned int i = 0; i < 3; i++){
+		input.setPin(i, pins[i]);
+		input.getButton(i).debounceUs = 0;
+		pins[i].level = true;
+	}
+	input.update();
+	REQUIRE(input.getDropped() == 1);
+	
+	buttonEvent event;
+	REQUIRE(input.poll(event));
+	REQUIRE(event.button == 0);
+	REQUIRE(event.kind == buttonEvent::type::PRESS);
+	REQUIRE(input.poll(event));
+	REQUIRE(event.button == 1);
+	REQUIRE_FALSE(input.poll(event));
+	
+	//room again
+	pins[2].level = false;
+	input.update();
+	REQUIRE(input.poll(event));
+	REQUIRE(event.button == 2);
+	REQUIRE(event.kind == buttonEvent::type::RELEASE);
+	REQUIRE(input.getDropped() == 1);
+}
+
+
+/* ------------- actionScheduler ------- */
+TEST_CASE("actionScheduler, runs an action to the end"){
+	hwlib::string<5> name;
+	name.clear() << "Lang";
+	stepItem item(name, 4);
+	lightMenu::actionScheduler scheduler;
+	
+	REQUIRE(scheduler.start(&item));
+	REQUIRE(scheduler.isBusy());
+	REQUIRE(scheduler.getRunning() == &item);
+	REQUIRE(scheduler.tick());
+	REQUIRE(scheduler.getProgress() == 25);
+	
+	//one action at a time
+	stepItem other(name, 1);
+	REQUIRE_FALSE(scheduler.start(&other));
+	REQUIRE(other.starts == 0);
+	
+	REQUIRE(scheduler.tick());
+	REQUIRE(scheduler.tick());
+	REQUIRE(scheduler.getFinished() == 0);
+	REQUIRE_FALSE(scheduler.tick());
+	REQUIRE(item.done == 4);
+	REQUIRE_FALSE(scheduler.isBusy());
+	REQUIRE(scheduler.getRunning() == NULL);
+	REQUIRE(scheduler.getProgress() == 0);
+	REQUIRE(scheduler.getFinished() == 1);
+	REQUIRE(item.cancels == 0);
+	REQUIRE_FALSE(scheduler.tick());
+}
+
+TEST_CASE("actionScheduler, a plain item runs at start"){
+	hwlib::string<5> name;
+	name.clear() << "Kort";
+	nameItem item(name);
+	lightMenu::actionScheduler scheduler;
+	
+	REQUIRE(scheduler.start(&item));
+	REQUIRE(item.runs == 1);
+	REQUIRE_FALSE(scheduler.isBusy());
+	REQUIRE(scheduler.getFinished() == 1);
+	REQUIRE_FALSE(scheduler.start(NULL));
+}
+
+TEST_CASE("actionScheduler, cancel"){
+	hwlib::string<5> name;
+	name.clear() << "Lang";
+	stepItem item(name, 10);
+	lightMenu::actionScheduler scheduler;
+	
+	//nothing to cancel
+	scheduler.cancel();
+	REQUIRE(scheduler.getFinished() == 0);
+	
+	REQUIRE(scheduler.start(&item));
+	REQUIRE(scheduler.tick());
+	scheduler.cancel();
+	REQUIRE(item.cancels == 1);
+	REQUIRE_FALSE(scheduler.isBusy());
+	REQUIRE(scheduler.getFinished() == 1);
+	REQUIRE_FALSE(scheduler.tick());
+	REQUIRE(item.done == 1);
+	
+	//free for the next one
+	REQUIRE(scheduler.start(&item));
+	REQUIRE(item.starts == 2);
+	REQUIRE(scheduler.isBusy());
+}
+
+TEST_CASE("actionScheduler, select starts the action on the scheduler"){
+	hwlib::string<5> name;
+	name.clear() << "Lang";
+	stepItem slow(name, 2);
+	nameItem quick(name);
+	std::array<lightMenu::menuItem*, 2> items = {&slow, &quick};
+	lightMenu::menu<2> mainMenu(items);
+	std::array<lightMenu::menu<2>*, 1> menus = {&mainMenu};
+	lightMenu::baseMenu<1, 2> base(menus);
+	lightMenu::actionScheduler scheduler;
+	base.setScheduler(&scheduler);
+	
+	base.select();
+	REQUIRE(slow.starts == 1);
+	REQUIRE(scheduler.getRunning() == &slow);
+	
+	//busy, so the second action is not started
+	base.cursorDown();
+	base.select();
+	REQUIRE(quick.runs == 0);
+	
+	REQUIRE(scheduler.tick());
+	REQUIRE_FALSE(scheduler.tick());
+	base.select();
+	REQUIRE(quick.runs == 1);
+	
+	//without a scheduler select() runs the item directly
+	base.setScheduler(NULL);
+	base.select();
+	REQUIRE(quick.runs == 2);
+	REQUIRE_FALSE(scheduler.isBusy());
+}
+
+
+/* ------------- oledMenu ------- */
+TEST_CASE("oledMenu, the window follows the cursor"){
+	hwlib::string<2> names[6];
+	nameItem * items[6];
+	std::array<lightMenu::menuItem*, 6> entries;
+	for(unsigned int i = 0; i < 6; i++){
+		names[i].clear() << char('A' + i);
+		items[i] = new nameItem(names[i]);
+		entries[i] = items[i];
+	}
+	lightMenu::menu<6> mainMenu(entries);
+	std::array<lightMenu::menu<6>*, 1> menus = {&mainMenu};
+	lightMenu::baseMenu<1, 6> base(menus);
+	pageBus bus;
+	hwlib::glcd_oled oled(bus, 0x3c);
+	oledMenu display(base, oled, bus, 0x3c, 3);
+	
+	display.draw();
+	REQUIRE(bus.writes == 8);
+	REQUIRE(bus.shows(0, *items[0]));
+	REQUIRE(bus.shows(2, *items[2]));
+	REQUIRE(bus.hasMarker(0));
+	for(unsigned int p = 3; p < 8; p++){
+		REQUIRE_FALSE(bus.hasMarker(p));
+		REQUIRE(bus.pages[p][9] == 0);
+	}
+	
+	//inside the window only the marker moves
+	bus.writes = 0;
+	base.setCursorPos(2);
+	display.draw();
+	REQUIRE(bus.writes == 2);
+	REQUIRE_FALSE(bus.hasMarker(0));
+	REQUIRE(bus.hasMarker(2));
+	
+	//past the last line the window scrolls one entry
+	bus.writes = 0;
+	base.setCursorPos(3);
+	display.draw();
+	REQUIRE(bus.writes == 3);
+	REQUIRE(bus.shows(0, *items[1]));
+	REQUIRE(bus.shows(2, *items[3]));
+	REQUIRE(bus.hasMarker(2));
+	REQUIRE_FALSE(bus.hasMarker(1));
+	
+	bus.writes = 0;
+	base.setCursorPos(5);
+	display.draw();
+	REQUIRE(bus.shows(0, *items[3]));
+	REQUIRE(bus.shows(2, *items[5]));
+	REQUIRE(bus.hasMarker(2));
+	
+	//the marker moves up first, then the window follows
+	bus.writes = 0;
+	base.setCursorPos(3);
+	display.draw();
+	REQUIRE(bus.writes == 2);
+	REQUIRE(bus.hasMarker(0));
+	base.setCursorPos(0);
+	display.draw();
+	REQUIRE(bus.shows(0, *items[0]));
+	REQUIRE(bus.shows(2, *items[2]));
+	REQUIRE(bus.hasMarker(0));
+	
+	//nothing changed, nothing sent
+	bus.writes = 0;
+	display.draw();
+	REQUIRE(bus.writes == 0);
+	
+	for(unsigned int i = 0; i < 6; i++){
+		delete items[i];
+	}
+}
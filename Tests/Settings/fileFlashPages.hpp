@@ -0,0 +1,130 @@
+#ifndef FILEFLASHPAGES_HPP
+#define FILEFLASHPAGES_HPP
+#include "hwlib.hpp"
+#include "flashPages.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// \brief
+/// Flash pages kept in a file, for host tests
+/// \details
+/// The pages are read from the file when it exists, a missing file is an
+/// erased flash. Every write is saved to the file at once, so a new
+/// fileFlashPages on the same file behaves like the device after a reset.
+///
+/// program() ANDs the data into the page like NOR flash does. Writes and
+/// erases are counted per page to check the wear levelling.
+/// tearNextErase() makes the next erase and write stop after the first few
+/// bytes, like a reset while the store copies its settings to a new page.
+class fileFlashPages : public flashPages{
+	static const unsigned int TORN_LENGTH = 8;
+	
+	std::string fileName;
+	unsigned int count;
+	std::vector<uint8_t> image;
+	std::vector<unsigned int> erases;
+	unsigned int writes = 0;
+	bool tearErase = false;
+	
+	void save(){
+		if(fileName.empty()){
+			return;
+		}
+		FILE * file = std::fopen(fileName.c_str(), "wb");
+		if(file != NULL){
+			std::fwrite(image.data(), 1, image.size(), file);
+			std::fclose(file);
+		}
+	}
+	
+	bool write(const unsigned int & page, const uint8_t data[PAGE_SIZE], const bool & erase){
+		if(page >= count){
+			return false;
+		}
+		uint8_t * target = &image[page * PAGE_SIZE];
+		unsigned int length = PAGE_SIZE;
+		bool torn = erase && tearErase;
+		if(torn){
+			length = TORN_LENGTH;
+			tearErase = false;
+		}
+		if(erase){
+			++erases[page];
+			for(unsigned int i = 0; i < PAGE_SIZE; i++){
+				target[i] = 0xFF;
+			}
+		}
+		for(unsigned int i = 0; i < length; i++){
+			target[i] &= data[i];
+		}
+		++writes;
+		save();
+		return !torn;
+	}
+	
+public:
+	/// \brief
+	/// Uses the given file, an empty name keeps the pages in memory only
+	fileFlashPages(const std::string & fileName, const unsigned int & count = 8):
+		fileName(fileName),
+		count(count),
+		image(count * PAGE_SIZE, 0xFF),
+		erases(count, 0)
+	{
+		if(fileName.empty()){
+			return;
+		}
+		FILE * file = std::fopen(fileName.c_str(), "rb");
+		if(file != NULL){
+			size_t length = std::fread(image.data(), 1, image.size(), file);
+			(void)length;
+			std::fclose(file);
+		}
+	}
+	
+	unsigned int getPageCount() const override{
+		return count;
+	}
+	
+	void read(const unsigned int & page, uint8_t data[PAGE_SIZE]) override{
+		for(unsigned int i = 0; i < PAGE_SIZE; i++){
+			data[i] = page < count ? image[page * PAGE_SIZE + i] : 0xFF;
+		}
+	}
+	
+	bool program(const unsigned int & page, const uint8_t data[PAGE_SIZE]) override{
+		return write(page, data, false);
+	}
+	
+	bool eraseAndProgram(const unsigned int & page, const uint8_t data[PAGE_SIZE]) override{
+		return write(page, data, true);
+	}
+	
+	/// \brief
+	/// Makes the next eraseAndProgram() stop after the first few bytes
+	void tearNextErase(){
+		tearErase = true;
+	}
+	
+	/// \brief
+	/// Returns the number of writes, programs and erases together
+	unsigned int getWrites() const{
+		return writes;
+	}
+	
+	/// \brief
+	/// Returns the number of times a page was erased
+	unsigned int getErases(const unsigned int & page) const{
+		return page < count ? erases[page] : 0;
+	}
+	
+	/// \brief
+	/// Flips bits of a stored byte, to damage a record
+	void corrupt(const unsigned int & page, const unsigned int & offset, const uint8_t & mask){
+		image[page * PAGE_SIZE + offset] ^= mask;
+		save();
+	}
+};
+
+#endif // FILEFLASHPAGES_HPP
@@ -0,0 +1,169 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
+#include "catch.hpp"
+
+#include "hwlib.hpp"
+#include "settingsStore.hpp"
+#include "fileFlashPages.hpp"
+#include <cstdio>
+//Tests of the settings store against fileFlashPages. A store made again on
+//the same pages is the device after a reset.
+
+struct difficulty{
+	int32_t gameWait;
+	int32_t gapWidth;
+};
+
+
+/* ------------- set and get ------- */
+TEST_CASE("settings, empty flash"){
+	fileFlashPages flash("");
+	settingsStore store(flash);
+	REQUIRE(store.load() == 0);
+	REQUIRE(store.getActivePage() == -1);
+	difficulty value = {1, 2};
+	REQUIRE(!store.get(1, 1, value));
+	REQUIRE(value.gameWait == 1);
+}
+
+TEST_CASE("settings, survive a reset"){
+	fileFlashPages flash("");
+	{
+		settingsStore store(flash);
+		store.load();
+		REQUIRE(store.set(1, 1, difficulty{200, 7}));
+		REQUIRE(store.set(2, 1, int16_t(-5)));
+	}
+	settingsStore store(flash);
+	REQUIRE(store.load() == 2);
+	difficulty value = {};
+	REQUIRE(store.get(1, 1, value));
+	REQUIRE(value.gameWait == 200);
+	REQUIRE(value.gapWidth == 7);
+	int16_t offset = 0;
+	REQUIRE(store.get(2, 1, offset));
+	REQUIRE(offset == -5);
+}
+
+TEST_CASE("settings, version and length have to match"){
+	fileFlashPages flash("");
+	settingsStore store(flash);
+	store.load();
+	REQUIRE(store.set(1, 1, difficulty{50, 3}));
+	difficulty value = {};
+	REQUIRE(!store.get(1, 2, value));
+	int32_t small = 0;
+	REQUIRE(!store.get(1, 1, small));
+	uint8_t tooLarge[settingsStore::MAX_DATA + 1] = {};
+	REQUIRE(!store.set(3, 1, tooLarge));
+}
+
+TEST_CASE("settings, a change costs one append"){
+	fileFlashPages flash("");
+	settingsStore store(flash);
+	store.load();
+	store.set(1, 1, difficulty{50, 3});
+	unsigned int writes = flash.getWrites();
+	REQUIRE(store.set(1, 1, difficulty{50, 3}));
+	REQUIRE(flash.getWrites() == writes);
+	REQUIRE(store.set(1, 1, difficulty{10, 1}));
+	REQUIRE(flash.getWrites() == writes + 1);
+	REQUIRE(store.getErases() == 1);
+}
+
+
+/* ------------- wear levelling ------- */
+TEST_CASE("settings, pages are used in turn"){
+	fileFlashPages flash("", 4);
+	settingsStore store(flash);
+	store.load();
+	for(int32_t i = 0; i < 1000; i++){
+		REQUIRE(store.set(1, 1, difficulty{i, i}));
+		REQUIRE(store.set(2, 1, i));
+	}
+	unsigned int least = flash.getErases(0);
+	unsigned int most = least;
+	for(unsigned int page = 1; page < 4; page++){
+		least = flash.getErases(page) < least ? flash.getErases(page) : least;
+		most = flash.getErases(page) > most ? flash.getErases(page) : most;
+	}
+	REQUIRE(least > 0);
+	REQUIRE(most - least <= 1);
+	
+	settingsStore again(flash);
+	REQUIRE(again.load() == 2);
+	difficulty value = {};
+	REQUIRE(again.get(1, 1, value));
+	REQUIRE(value.gameWait == 999);
+	int32_t last = 0;
+	REQUIRE(again.get(2, 1, last));
+	REQUIRE(last == 999);
+}
+
+
+/* ------------- damaged records ------- */
+TEST_CASE("settings, a damaged record ends the page"){
+	fileFlashPages flash("");
+	settingsStore store(flash);
+	store.load();
+	store.set(1, 1, int32_t(1));
+	store.set(1, 1, int32_t(2));
+	// the second record starts after the header and the first record
+	flash.corrupt(store.getActivePage(), 4 + 9 + 3, 0x01);
+	
+	settingsStore again(flash);
+	REQUIRE(again.load() == 1);
+	int32_t value = 0;
+	REQUIRE(again.get(1, 1, value));
+	REQUIRE(value == 1);
+	// the next change does not append after the damage
+	REQUIRE(again.set(1, 1, int32_t(3)));
+	settingsStore third(flash);
+	third.load();
+	REQUIRE(third.get(1, 1, value));
+	REQUIRE(value == 3);
+}
+
+TEST_CASE("settings, a reset while copying to a new page loses nothing"){
+	fileFlashPages flash("", 2);
+	settingsStore store(flash);
+	store.load();
+	int32_t i = 0;
+	while(store.getErases() < 2){
+		store.set(1, 1, ++i);
+		store.set(2, 1, int16_t(7));
+	}
+	int32_t stored = i;
+	// fill the active page, then tear the copy to the next one
+	flash.tearNextErase();
+	while(store.set(1, 1, ++i)){
+		stored = i;
+	}
+	
+	settingsStore again(flash);
+	REQUIRE(again.load() == 2);
+	int32_t value = 0;
+	REQUIRE(again.get(1, 1, value));
+	REQUIRE(value == stored);
+	int16_t other = 0;
+	REQUIRE(again.get(2, 1, other));
+	REQUIRE(other == 7);
+	REQUIRE(again.set(1, 1, ++i));
+}
+
+TEST_CASE("settings, file backed pages"){
+	const char * name = "settingsTest.bin";
+	std::remove(name);
+	{
+		fileFlashPages flash(name);
+		settingsStore store(flash);
+		store.load();
+		REQUIRE(store.set(1, 1, difficulty{200, 7}));
+	}
+	fileFlashPages flash(name);
+	settingsStore store(flash);
+	REQUIRE(store.load() == 1);
+	difficulty value = {};
+	REQUIRE(store.get(1, 1, value));
+	REQUIRE(value.gapWidth == 7);
+	std::remove(name);
+}
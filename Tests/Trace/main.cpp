@@ -0,0 +1,100 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
+#include "catch.hpp"
+
+#include "hwlib.hpp"
+#include "tracer.hpp"
+//Tests of the tracer with recorded durations, so the results do not depend
+//on the speed of the host.
+
+
+/* ------------- spans ------- */
+TEST_CASE("tracer, spans and unknown spans"){
+	tracer trace;
+	int first = trace.addSpan("first");
+	int second = trace.addSpan("second");
+	REQUIRE(first == 0);
+	REQUIRE(second == 1);
+	trace.record(first, 10 * tracer::getTicksPerUs());
+	trace.record(-1, 10);
+	trace.record(5, 10);
+	REQUIRE(trace.getCount(first) == 1);
+	REQUIRE(trace.getCount(second) == 0);
+	for(unsigned int i = 2; i < tracer::MAX_SPANS; i++){
+		REQUIRE(trace.addSpan("more") == int(i));
+	}
+	REQUIRE(trace.addSpan("too many") == -1);
+}
+
+TEST_CASE("tracer, scope without a tracer does nothing"){
+	traceScope scope(NULL, 0);
+}
+
+TEST_CASE("tracer, scope records the time"){
+	tracer trace;
+	int span = trace.addSpan("scope");
+	{
+		traceScope scope(&trace, span);
+	}
+	REQUIRE(trace.getCount(span) == 1);
+}
+
+
+/* ------------- statistics ------- */
+TEST_CASE("tracer, percentiles and max"){
+	tracer trace;
+	int fast = trace.addSpan("fast");
+	int slow = trace.addSpan("slow");
+	// 1 to 100 us in descending order, interleaved over two spans
+	for(uint32_t us = 100; us > 0; us--){
+		trace.record(fast, us * tracer::getTicksPerUs());
+		trace.record(slow, us * 10 * tracer::getTicksPerUs());
+	}
+	uint32_t p50 = 0;
+	uint32_t p99 = 0;
+	REQUIRE(trace.getPercentiles(fast, p50, p99));
+	REQUIRE(p50 == 50);
+	REQUIRE(p99 == 99);
+	REQUIRE(trace.getMaxUs(fast) == 100);
+	REQUIRE(trace.getPercentiles(slow, p50, p99));
+	REQUIRE(p50 == 500);
+	REQUIRE(trace.getMaxUs(slow) == 1000);
+	trace.clear();
+	REQUIRE(!trace.getPercentiles(fast, p50, p99));
+	REQUIRE(trace.getCount(fast) == 0);
+}
+
+TEST_CASE("tracer, ring buffer keeps the newest durations"){
+	tracer trace;
+	int span = trace.addSpan("span");
+	for(unsigned int i = 0; i < tracer::EVENTS; i++){
+		trace.record(span, 1000 * tracer::getTicksPerUs());
+	}
+	for(unsigned int i = 0; i < tracer::EVENTS; i++){
+		trace.record(span, 2 * tracer::getTicksPerUs());
+	}
+	uint32_t p50 = 0;
+	uint32_t p99 = 0;
+	REQUIRE(trace.getPercentiles(span, p50, p99));
+	REQUIRE(p99 == 2);
+	// the histogram and max count everything
+	REQUIRE(trace.getCount(span) == 2 * tracer::EVENTS);
+	REQUIRE(trace.getMaxUs(span) == 1000);
+}
+
+TEST_CASE("tracer, histogram buckets"){
+	tracer trace;
+	int span = trace.addSpan("span");
+	trace.record(span, 0);
+	trace.record(span, 1 * tracer::getTicksPerUs());
+	trace.record(span, 3 * tracer::getTicksPerUs());
+	trace.record(span, 4 * tracer::getTicksPerUs());
+	trace.record(span, 0xFFFFFFFF);
+	REQUIRE(trace.getBucket(span, 0) == 1);
+	REQUIRE(trace.getBucket(span, 1) == 1);
+	REQUIRE(trace.getBucket(span, 2) == 1);
+	REQUIRE(trace.getBucket(span, 3) == 1);
+	REQUIRE(trace.getBucket(span, tracer::BUCKETS - 1) == 1);
+	trace.setEnabled(false);
+	trace.record(span, 0);
+	REQUIRE(trace.getCount(span) == 5);
+}